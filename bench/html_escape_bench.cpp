@@ -0,0 +1,124 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   html_escape_bench.cpp
+ * Author: alex
+ *
+ * Created on October 27, 2026, 6:10 PM
+ */
+
+// Compares 'append_html_escaped' with the byte-by-byte escaping loop
+// that was used before it.
+//
+// usage: wilton_server_html_escape_bench [iterations]
+//
+// outputs of both are checked to be equal on random short strings
+// first, then throughput is measured on 200KB texts with different
+// share of the characters that need escaping
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "html_escape.hpp"
+
+namespace { // anonymous
+
+const size_t fuzz_cases = 100000;
+
+const size_t text_len = 200000;
+
+// escaping loop used before 'append_html_escaped'
+void append_html_escaped_bytewise(std::string& out, const char* data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char ch = data[i];
+        switch (ch) {
+        case '&': out.append("&amp;"); break;
+        case '<': out.append("&lt;"); break;
+        case '>': out.append("&gt;"); break;
+        case '"': out.append("&quot;"); break;
+        case '\'': out.append("&#39;"); break;
+        case '/': out.append("&#x2F;"); break;
+        default: out.push_back(ch);
+        }
+    }
+}
+
+bool check_equivalence(std::mt19937& rng) {
+    // escaped characters, bytes with the high bit set and plain text
+    static const std::string alphabet = "abc&<>\"'/xyz 0123\xff\x80";
+    for (size_t t = 0; t < fuzz_cases; t++) {
+        auto text = std::string();
+        size_t len = rng() % 70;
+        for (size_t i = 0; i < len; i++) {
+            text.push_back(alphabet[rng() % alphabet.length()]);
+        }
+        auto expected = std::string();
+        append_html_escaped_bytewise(expected, text.data(), text.length());
+        auto actual = std::string();
+        wilton::server::append_html_escaped(actual, text.data(), text.length());
+        if (expected != actual) {
+            std::cerr << "MISMATCH: [" << text << "]" << std::endl;
+            std::cerr << "  bytewise: [" << expected << "]" << std::endl;
+            std::cerr << "  current:  [" << actual << "]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+template<typename Fun>
+double measure_mbps(Fun fun, const std::string& text, std::string& out, size_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iterations; i++) {
+        out.clear();
+        fun(out, text.data(), text.length());
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(text.length() * iterations) / (1024 * 1024) / elapsed.count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t iterations = argc > 1 ? static_cast<size_t>(std::strtoul(argv[1], nullptr, 10)) : 200;
+    auto rng = std::mt19937(1);
+    if (!check_equivalence(rng)) {
+        return 1;
+    }
+    std::cout << "equivalence: [" << fuzz_cases << "] cases OK" << std::endl;
+    static const std::string plain = "lorem ipsum dolor";
+    for (uint32_t percent : {0, 1, 10, 50}) {
+        auto text = std::string();
+        for (size_t i = 0; i < text_len; i++) {
+            bool escaped = percent > 0 && rng() % 100 < percent;
+            text.push_back(escaped ? '<' : plain[i % plain.length()]);
+        }
+        auto out = std::string();
+        out.reserve(text.length() * 4);
+        double bytewise = measure_mbps(append_html_escaped_bytewise, text, out, iterations);
+        double current = measure_mbps(wilton::server::append_html_escaped, text, out, iterations);
+        std::cout << "escaped: [" << percent << "%]," <<
+                " bytewise: [" << static_cast<uint64_t>(bytewise) << " MB/s]," <<
+                " current: [" << static_cast<uint64_t>(current) << " MB/s]," <<
+                " speedup: [" << (current / bytewise) << "]" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   mustache_golden.cpp
+ * Author: alex
+ *
+ * Created on October 27, 2026, 11:20 AM
+ */
+
+// Compares output of the compiled mustache renderer with the output
+// of 'staticlib_mustache' (mstch) that was used before it.
+//
+// usage: wilton_server_mustache_golden [templates_dir [partials_dir]]
+//
+// built-in cases are always checked, every '*.mustache' file from
+// 'templates_dir' is rendered with the data from the '*.json' file
+// with the same name (empty object if there is none)
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/mustache.hpp"
+#include "staticlib/tinydir.hpp"
+#include "staticlib/utils.hpp"
+
+#include "mustache_template.hpp"
+
+namespace { // anonymous
+
+class golden_case {
+public:
+    std::string name;
+    std::string text;
+    std::string data;
+};
+
+const std::string mustache_ext = ".mustache";
+
+std::string read_file(const std::string& file_path) {
+    auto src = sl::tinydir::file_source(file_path);
+    auto sink = sl::io::string_sink();
+    sl::io::copy_all(src, sink);
+    return std::move(sink.get_string());
+}
+
+std::string render_mstch(const std::string& text, const sl::json::value& json,
+        const std::map<std::string, std::string>& partials) {
+    auto src = sl::mustache::source(json.clone(), text, partials);
+    auto sink = sl::io::string_sink();
+    sl::io::copy_all(src, sink);
+    return std::move(sink.get_string());
+}
+
+std::string render_compiled(const std::string& text, const sl::json::value& json,
+        const wilton::server::mustache_partials_map& partials) {
+    auto tmpl = wilton::server::compile_mustache(text);
+    return wilton::server::render_mustache(*tmpl, json, partials);
+}
+
+bool check(const golden_case& gc, const std::map<std::string, std::string>& partials_text,
+        const wilton::server::mustache_partials_map& partials) {
+    auto json = sl::json::loads(gc.data);
+    auto expected = render_mstch(gc.text, json, partials_text);
+    auto actual = render_compiled(gc.text, json, partials);
+    if (expected == actual) {
+        return true;
+    }
+    std::cerr << "MISMATCH: [" << gc.name << "]" << std::endl;
+    std::cerr << "  mstch:    [" << expected << "]" << std::endl;
+    std::cerr << "  compiled: [" << actual << "]" << std::endl;
+    return false;
+}
+
+std::vector<golden_case> builtin_cases() {
+    return {
+        {"variables", "{{a}} {{{b}}} {{&b}} {{missing}}|", R"({"a": "<&\"'/>", "b": "<b>"})"},
+        {"numbers", "{{i}} {{r}} {{t}} {{f}}", R"({"i": 42, "r": 1.5, "t": true, "f": false})"},
+        {"dotted", "{{a.b.c}} {{#a}}{{b.c}}{{/a}}", R"({"a": {"b": {"c": "x"}}})"},
+        {"sections", "{{#list}}[{{.}}]{{/list}}{{^list}}none{{/list}}", R"({"list": [1, 2, 3]})"},
+        {"empty_list", "{{#list}}[{{.}}]{{/list}}{{^list}}none{{/list}}", R"({"list": []})"},
+        {"falsy", "{{#z}}z{{/z}}{{#e}}e{{/e}}{{#n}}n{{/n}}", R"({"z": 0, "e": "", "n": null})"},
+        {"object_section", "{{#o}}{{x}}-{{y}}{{/o}}", R"({"o": {"x": 1}, "y": 2})"},
+        {"standalone", "a\n  {{#s}}\nb\n  {{/s}}\nc\n", R"({"s": true})"},
+        {"comment", "a {{! comment }}b\n{{! standalone }}\nc", "{}"},
+        {"delimiters", "{{=<% %>=}}<%a%> {{a}} <%={{ }}=%>{{a}}", R"({"a": "x"})"},
+        {"triple_custom_delimiters", "{{=<% %>=}}<%{a}%> <%&a%>", R"({"a": "<i>"})"},
+        {"partials", "[{{>part}}] [{{>missing}}]", R"({"p": "<v>"})"},
+        {"crlf", "{{#s}}\r\nx\r\n{{/s}}\r\n", R"({"s": true})"}
+    };
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    auto partials_text = std::map<std::string, std::string>();
+    partials_text.insert(std::make_pair("part", "p={{p}}"));
+    if (argc > 2) {
+        for (const sl::tinydir::path& tf : sl::tinydir::list_directory(argv[2])) {
+            if (!sl::utils::ends_with(tf.filename(), mustache_ext)) continue;
+            auto name = tf.filename().substr(0, tf.filename().length() - mustache_ext.length());
+            partials_text[name] = read_file(tf.filepath());
+        }
+    }
+    auto partials = wilton::server::mustache_partials_map();
+    for (auto& pa : partials_text) {
+        partials.insert(std::make_pair(pa.first, wilton::server::compile_mustache(pa.second)));
+    }
+    auto cases = builtin_cases();
+    if (argc > 1) {
+        auto files = std::map<std::string, std::string>();
+        for (const sl::tinydir::path& tf : sl::tinydir::list_directory(argv[1])) {
+            files.insert(std::make_pair(tf.filename(), tf.filepath()));
+        }
+        for (auto& fi : files) {
+            if (!sl::utils::ends_with(fi.first, mustache_ext)) continue;
+            auto data_name = fi.first.substr(0, fi.first.length() - mustache_ext.length()) + ".json";
+            auto data_it = files.find(data_name);
+            auto data = files.end() != data_it ? read_file(data_it->second) : std::string("{}");
+            cases.push_back({fi.second, read_file(fi.second), data});
+        }
+    }
+    size_t failed = 0;
+    for (auto& gc : cases) {
+        if (!check(gc, partials_text, partials)) {
+            failed += 1;
+        }
+    }
+    std::cout << "cases: [" << cases.size() << "], mismatches: [" << failed << "]" << std::endl;
+    return 0 == failed ? 0 : 1;
+}
@@ -79,17 +79,41 @@ char* wilton_HttpPath_destroy(
             "mimeTypes": [{
                 "extension": ".css",
                 "mime": "text/css"
-            }, ...]
+            }, ...],
+            "fileCache": {
+                "maxEntries": uint32_t,
+                "revalidateIntervalMillis": uint32_t,
+                "useInotify": true|false
+            },
+            "servePrecompressed": true|false,
+            "zipEntryCacheMaxBytes": uint32_t,
+            "zipDeflatePassthrough": true|false,
+            "zipIndexPath": "path/to/index/file"
         }, ...],
         "requestPayload": {
             "tmpDirPath": "path/to/writable/directory",
             "tmpFilenameLength": uint16_t,
-            "memoryLimitBytes": uint32_t
+            "memoryLimitBytes": uint32_t,
+            "parseMultipart": bool
         },
         "mustache": {
-            "partialsDirs": ["path/to/dir1", "path/to/dir2" ...]
+            "partialsDirs": ["path/to/dir1", "path/to/dir2" ...],
+            "templateDirs": ["path/to/dir1", "path/to/dir2" ...],
+            "cacheMaxEntries": uint32_t,
+            "cacheMaxBytes": uint32_t,
+            "useInotify": bool,
+            "renderCacheMaxBytes": uint32_t,
+            "renderCacheTtlMillis": uint32_t,
+            "renderBufferMaxBytes": uint32_t
         },
-        "rootRedirectLocation": "http://some/url"
+        "rootRedirectLocation": "http://some/url",
+        "assetCache": {
+            "maxBytes": uint32_t,
+            "maxEntryBytes": uint32_t,
+            "evictionPolicy": "LRU"|"LFU"
+        },
+        "blockingIoThreads": uint32_t,
+        "resourceCacheMaxBytes": uint32_t
     }
  */
 char* wilton_Server_create(
@@ -115,6 +139,58 @@ char* wilton_Server_get_tcp_port(
         wilton_Server* server,
         int* port_out);
 
+/*
+    {
+        "hits": uint64_t,
+        "misses": uint64_t,
+        "evictions": uint64_t,
+        "entries": uint64_t,
+        "bytes": uint64_t
+    }
+ */
+char* wilton_Server_get_asset_cache_stats(
+        wilton_Server* server,
+        char** stats_json_out,
+        int* stats_json_len_out);
+
+/*
+    {
+        "threads": uint64_t,
+        "ioThreadBlockedMicros": uint64_t,
+        "inlineReads": uint64_t,
+        "offloadedReads": uint64_t
+    }
+ */
+char* wilton_Server_get_blocking_io_stats(
+        wilton_Server* server,
+        char** stats_json_out,
+        int* stats_json_len_out);
+
+// empty prefix drops all cached resources
+char* wilton_Server_invalidate_resource_cache(
+        wilton_Server* server,
+        const char* prefix,
+        int prefix_len);
+
+/*
+    [
+        {
+            "path": "path/to/template.mustache",
+            "bytes": uint64_t
+        },
+        ...
+    ]
+ */
+char* wilton_Server_get_mustache_templates(
+        wilton_Server* server,
+        char** templates_json_out,
+        int* templates_json_len_out);
+
+// drops compiled mustache templates and reloads partials,
+// previous partials are kept on error
+char* wilton_Server_reload_mustache(
+        wilton_Server* server);
+
 /*
 // Duplicates in raw headers are handled in the following ways, depending on the header name:
 // Duplicates of age, authorization, content-length, content-type, etag, expires, 
@@ -149,11 +225,50 @@ char* wilton_Request_get_request_data(
         char** data_out,
         int* data_len_out);
 
+// body spooled to 'requestPayload.tmpDirPath' is memory-mapped,
+// returned pointer stays valid until the request is destroyed
+char* wilton_Request_get_request_data_span(
+        wilton_Request* request,
+        const char** data_out,
+        long long* data_len_out);
+
+// copies up to 'length' bytes of the body starting from 'offset',
+// returns less bytes at the end of the body
+char* wilton_Request_read_request_data(
+        wilton_Request* request,
+        long long offset,
+        int length,
+        char** data_out,
+        int* data_len_out);
+
 char* wilton_Request_get_request_form_data(
         wilton_Request* request,
         char** data_out,
         int* data_len_out);
 
+/*
+{
+    "fields": {
+        "name": "value",
+        ...
+    },
+    "files": [
+        {
+            "name": "field_name",
+            "filename": "uploaded_file_name",
+            "contentType": "application/octet-stream",
+            "size": uint64_t,
+            "path": "path/to/tmp/file"
+        },
+        ...
+    ]
+}
+ */
+char* wilton_Request_get_request_multipart_data(
+        wilton_Request* request,
+        char** data_out,
+        int* data_len_out);
+
 char* wilton_Request_get_request_data_filename(
         wilton_Request* request,
         char** filename_out,
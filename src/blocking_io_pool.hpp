@@ -0,0 +1,220 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   blocking_io_pool.hpp
+ * Author: alex
+ *
+ * Created on October 19, 2026, 10:15 AM
+ */
+
+#ifndef WILTON_SERVER_BLOCKING_IO_POOL_HPP
+#define WILTON_SERVER_BLOCKING_IO_POOL_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "staticlib/config.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+namespace wilton {
+namespace server {
+
+/**
+ * Threads for blocking disk reads of streamed responses, so page cache
+ * misses do not stall IO threads; with zero threads reads are done
+ * inline on IO threads; time that IO threads spend in disk reads
+ * (inline reads and 'sendfile' calls) is accounted in stats
+ */
+class blocking_io_pool {
+    class pool_task {
+    public:
+        std::function<void()> task;
+        // called instead of the task if it is not run because pool is stopped
+        std::function<void()> cancel;
+    };
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<pool_task> queue;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+
+    std::atomic<uint64_t> io_thread_blocked_micros;
+    std::atomic<uint64_t> inline_reads;
+    std::atomic<uint64_t> offloaded_reads;
+
+public:
+    blocking_io_pool(uint32_t threads_count) :
+    io_thread_blocked_micros(0),
+    inline_reads(0),
+    offloaded_reads(0) {
+        for (uint32_t i = 0; i < threads_count; i++) {
+            workers.emplace_back([this] {
+                this->work();
+            });
+        }
+    }
+
+    blocking_io_pool(const blocking_io_pool&) = delete;
+
+    blocking_io_pool& operator=(const blocking_io_pool&) = delete;
+
+    ~blocking_io_pool() STATICLIB_NOEXCEPT {
+        stop();
+    }
+
+    /**
+     * Cancels pending tasks and joins pool threads, tasks submitted
+     * after this call are cancelled on the calling thread; must be called
+     * before the objects that cancel callbacks use are destroyed
+     */
+    void stop() STATICLIB_NOEXCEPT {
+        auto dropped = std::deque<pool_task>();
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            stopping = true;
+            dropped.swap(queue);
+        }
+        cv.notify_all();
+        for (auto& th : workers) {
+            if (th.joinable()) {
+                th.join();
+            }
+        }
+        // cancelled outside of the lock, so callbacks may submit
+        for (auto& pt : dropped) {
+            cancel_noexcept(pt);
+        }
+    }
+
+    /**
+     * Whether reads are offloaded from IO threads
+     *
+     * @return false if pool has no threads
+     */
+    bool has_workers() const {
+        return !workers.empty();
+    }
+
+    /**
+     * Enqueues task for one of the pool threads,
+     * must not be called if pool has no threads
+     *
+     * @param task blocking task
+     * @param cancel called instead of the task when the pool is stopped
+     *        before the task is run, must run the failure path of the task owner
+     */
+    void submit(std::function<void()> task, std::function<void()> cancel) {
+        auto pt = pool_task();
+        pt.task = std::move(task);
+        pt.cancel = std::move(cancel);
+        bool queued = false;
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            if (!stopping) {
+                queue.emplace_back(std::move(pt));
+                queued = true;
+            }
+        }
+        if (!queued) {
+            // called without the lock on the submitting thread
+            cancel_noexcept(pt);
+            return;
+        }
+        offloaded_reads.fetch_add(1, std::memory_order_relaxed);
+        cv.notify_one();
+    }
+
+    /**
+     * Runs blocking task on the calling IO thread accounting its time
+     *
+     * @param task blocking task
+     */
+    template<typename Task>
+    auto run_inline(Task task) -> decltype(task()) {
+        inline_reads.fetch_add(1, std::memory_order_relaxed);
+        auto start = std::chrono::steady_clock::now();
+        auto deferred = sl::support::defer([this, start]() STATICLIB_NOEXCEPT {
+            this->add_io_thread_blocked(std::chrono::steady_clock::now() - start);
+        });
+        return task();
+    }
+
+    /**
+     * Accounts time that IO thread spent in a blocking disk read
+     * done outside of the pool, e.g. in 'sendfile'
+     *
+     * @param elapsed blocked time
+     */
+    void add_io_thread_blocked(std::chrono::steady_clock::duration elapsed) STATICLIB_NOEXCEPT {
+        auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+        io_thread_blocked_micros.fetch_add(static_cast<uint64_t>(micros), std::memory_order_relaxed);
+    }
+
+    sl::json::value stats() const {
+        return {
+            { "threads", static_cast<uint64_t>(workers.size()) },
+            { "ioThreadBlockedMicros", io_thread_blocked_micros.load(std::memory_order_relaxed) },
+            { "inlineReads", inline_reads.load(std::memory_order_relaxed) },
+            { "offloadedReads", offloaded_reads.load(std::memory_order_relaxed) }
+        };
+    }
+
+private:
+    void work() {
+        for (;;) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                cv.wait(lock, [this] {
+                    return stopping || !queue.empty();
+                });
+                // pending reads are cancelled by 'stop'
+                if (stopping) {
+                    return;
+                }
+                task = std::move(queue.front().task);
+                queue.pop_front();
+            }
+            task();
+        }
+    }
+
+    static void cancel_noexcept(pool_task& pt) STATICLIB_NOEXCEPT {
+        try {
+            pt.cancel();
+        } catch (...) {
+            // failure path must not prevent other tasks from being cancelled
+        }
+        pt.task = nullptr;
+        pt.cancel = nullptr;
+    }
+
+};
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_BLOCKING_IO_POOL_HPP */
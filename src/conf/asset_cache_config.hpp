@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   asset_cache_config.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 3:10 PM
+ */
+
+#ifndef WILTON_SERVER_CONF_ASSET_CACHE_CONFIG_HPP
+#define WILTON_SERVER_CONF_ASSET_CACHE_CONFIG_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "staticlib/json.hpp"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace server {
+namespace conf {
+
+class asset_cache_config {
+public:
+    // zero disables caching
+    uint32_t maxBytes = 0;
+    uint32_t maxEntryBytes = 65536;
+    // "LRU" or "LFU"
+    std::string evictionPolicy = "LRU";
+
+    asset_cache_config(const asset_cache_config&) = delete;
+
+    asset_cache_config& operator=(const asset_cache_config&) = delete;
+
+    asset_cache_config(asset_cache_config&& other) :
+    maxBytes(other.maxBytes),
+    maxEntryBytes(other.maxEntryBytes),
+    evictionPolicy(std::move(other.evictionPolicy)) { }
+
+    asset_cache_config& operator=(asset_cache_config&& other) {
+        this->maxBytes = other.maxBytes;
+        this->maxEntryBytes = other.maxEntryBytes;
+        this->evictionPolicy = std::move(other.evictionPolicy);
+        return *this;
+    }
+
+    asset_cache_config() { }
+
+    asset_cache_config(uint32_t maxBytes, uint32_t maxEntryBytes, const std::string& evictionPolicy) :
+    maxBytes(maxBytes),
+    maxEntryBytes(maxEntryBytes),
+    evictionPolicy(evictionPolicy.data(), evictionPolicy.length()) { }
+
+    asset_cache_config(const sl::json::value& json) {
+        for (const sl::json::field& fi : json.as_object()) {
+            auto& name = fi.name();
+            if ("maxBytes" == name) {
+                this->maxBytes = fi.as_uint32_or_throw(name);
+            } else if ("maxEntryBytes" == name) {
+                this->maxEntryBytes = fi.as_uint32_or_throw(name);
+            } else if ("evictionPolicy" == name) {
+                this->evictionPolicy = fi.as_string_nonempty_or_throw(name);
+                if (!("LRU" == evictionPolicy || "LFU" == evictionPolicy)) throw support::exception(TRACEMSG(
+                        "Invalid 'assetCache.evictionPolicy' field: [" + evictionPolicy + "]," +
+                        " supported values: [LRU, LFU]"));
+            } else {
+                throw support::exception(TRACEMSG("Unknown 'assetCache' field: [" + name + "]"));
+            }
+        }
+    }
+
+    sl::json::value to_json() const {
+        return {
+            { "maxBytes", maxBytes },
+            { "maxEntryBytes", maxEntryBytes },
+            { "evictionPolicy", evictionPolicy }
+        };
+    }
+
+    bool is_enabled() const {
+        return maxBytes > 0;
+    }
+
+    asset_cache_config clone() const {
+        return asset_cache_config{maxBytes, maxEntryBytes, evictionPolicy};
+    }
+
+};
+
+} // namespace
+}
+}
+
+#endif /* WILTON_SERVER_CONF_ASSET_CACHE_CONFIG_HPP */
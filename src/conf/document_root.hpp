@@ -34,6 +34,7 @@
 
 #include "wilton/support/exception.hpp"
 
+#include "conf/file_cache_config.hpp"
 #include "conf/mime_type.hpp"
 
 namespace wilton {
@@ -50,6 +51,15 @@ public:
     std::string resourceLoaderPrefix = "";
     uint32_t cacheMaxAgeSeconds = 604800;
     std::vector<mime_type> mimeTypes = default_mimes();
+    file_cache_config fileCache;
+    // serve '.br' and '.gz' siblings of requested files when accepted by client
+    bool servePrecompressed = false;
+    // budget for inflated entries of 'zipPath', zero disables caching
+    uint32_t zipEntryCacheMaxBytes = 0;
+    // send deflated entries of 'zipPath' as gzip without inflating them
+    bool zipDeflatePassthrough = false;
+    // persisted central directory index of 'zipPath', empty disables persisting
+    std::string zipIndexPath = "";
     
     document_root(const document_root&) = delete;
     
@@ -63,7 +73,12 @@ public:
     useResourceLoader(other.useResourceLoader),
     resourceLoaderPrefix(std::move(other.resourceLoaderPrefix)),
     cacheMaxAgeSeconds(other.cacheMaxAgeSeconds),
-    mimeTypes(std::move(other.mimeTypes)) {
+    mimeTypes(std::move(other.mimeTypes)),
+    fileCache(std::move(other.fileCache)),
+    servePrecompressed(other.servePrecompressed),
+    zipEntryCacheMaxBytes(other.zipEntryCacheMaxBytes),
+    zipDeflatePassthrough(other.zipDeflatePassthrough),
+    zipIndexPath(std::move(other.zipIndexPath)) {
         other.useResourceLoader = false;
     }
 
@@ -77,6 +92,11 @@ public:
         this->resourceLoaderPrefix = std::move(other.resourceLoaderPrefix);
         this->cacheMaxAgeSeconds = other.cacheMaxAgeSeconds;
         this->mimeTypes = std::move(other.mimeTypes);
+        this->fileCache = std::move(other.fileCache);
+        this->servePrecompressed = other.servePrecompressed;
+        this->zipEntryCacheMaxBytes = other.zipEntryCacheMaxBytes;
+        this->zipDeflatePassthrough = other.zipDeflatePassthrough;
+        this->zipIndexPath = std::move(other.zipIndexPath);
         return *this;
     }
 
@@ -85,7 +105,10 @@ public:
     document_root(const std::string& resource, const std::string& dirPath, 
             const std::string& zipPath, const std::string& zipInnerPrefix,
             bool useResourceLoader, const std::string& resourceLoaderPrefix,
-            uint32_t cacheMaxAgeSeconds, const std::vector<mime_type>& mimeTypes) :
+            uint32_t cacheMaxAgeSeconds, const std::vector<mime_type>& mimeTypes,
+            const file_cache_config& fileCache, bool servePrecompressed,
+            uint32_t zipEntryCacheMaxBytes, bool zipDeflatePassthrough,
+            const std::string& zipIndexPath) :
     resource(resource.data(), resource.length()), 
     dirPath(dirPath.data(), dirPath.length()), 
     zipPath(zipPath.data(), zipPath.length()), 
@@ -93,7 +116,12 @@ public:
     useResourceLoader(useResourceLoader),
     resourceLoaderPrefix(resourceLoaderPrefix.data(), resourceLoaderPrefix.length()), 
     cacheMaxAgeSeconds(cacheMaxAgeSeconds), 
-    mimeTypes(mimes_copy(mimeTypes)) { }
+    mimeTypes(mimes_copy(mimeTypes)),
+    fileCache(fileCache.clone()),
+    servePrecompressed(servePrecompressed),
+    zipEntryCacheMaxBytes(zipEntryCacheMaxBytes),
+    zipDeflatePassthrough(zipDeflatePassthrough),
+    zipIndexPath(zipIndexPath.data(), zipIndexPath.length()) { }
 
     document_root(const sl::json::value& json) {
         for (const sl::json::field& fi : json.as_object()) {
@@ -117,6 +145,16 @@ public:
                     auto ja = server::conf::mime_type(ap);
                     mimeTypes.emplace_back(std::move(ja));
                 }
+            } else if ("fileCache" == name) {
+                this->fileCache = file_cache_config(fi.val());
+            } else if ("servePrecompressed" == name) {
+                this->servePrecompressed = fi.as_bool_or_throw(name);
+            } else if ("zipEntryCacheMaxBytes" == name) {
+                this->zipEntryCacheMaxBytes = fi.as_uint32_or_throw(name);
+            } else if ("zipDeflatePassthrough" == name) {
+                this->zipDeflatePassthrough = fi.as_bool_or_throw(name);
+            } else if ("zipIndexPath" == name) {
+                this->zipIndexPath = fi.as_string_nonempty_or_throw(name);
             } else {
                 throw support::exception(TRACEMSG("Unknown 'documentRoot' field: [" + name + "]"));
             }
@@ -142,7 +180,12 @@ public:
                     return el.to_json();
                 });
                 return ra.to_vector();
-            }()}
+            }()},
+            {"fileCache", fileCache.to_json()},
+            {"servePrecompressed", servePrecompressed},
+            {"zipEntryCacheMaxBytes", zipEntryCacheMaxBytes},
+            {"zipDeflatePassthrough", zipDeflatePassthrough},
+            {"zipIndexPath", zipIndexPath}
         };
     }
 
@@ -152,7 +195,9 @@ public:
 
     document_root clone() const {
         return document_root(resource, dirPath, zipPath, zipInnerPrefix,
-                useResourceLoader, resourceLoaderPrefix, cacheMaxAgeSeconds, mimeTypes);
+                useResourceLoader, resourceLoaderPrefix, cacheMaxAgeSeconds, mimeTypes,
+                fileCache, servePrecompressed, zipEntryCacheMaxBytes, zipDeflatePassthrough,
+                zipIndexPath);
     }
 
 private:
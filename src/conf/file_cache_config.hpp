@@ -0,0 +1,104 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   file_cache_config.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 1:05 PM
+ */
+
+#ifndef WILTON_SERVER_CONF_FILE_CACHE_CONFIG_HPP
+#define WILTON_SERVER_CONF_FILE_CACHE_CONFIG_HPP
+
+#include <cstdint>
+
+#include "staticlib/json.hpp"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace server {
+namespace conf {
+
+class file_cache_config {
+public:
+    // zero disables caching
+    uint32_t maxEntries = 0;
+    uint32_t revalidateIntervalMillis = 1000;
+    bool useInotify = true;
+
+    file_cache_config(const file_cache_config&) = delete;
+
+    file_cache_config& operator=(const file_cache_config&) = delete;
+
+    file_cache_config(file_cache_config&& other) :
+    maxEntries(other.maxEntries),
+    revalidateIntervalMillis(other.revalidateIntervalMillis),
+    useInotify(other.useInotify) { }
+
+    file_cache_config& operator=(file_cache_config&& other) {
+        this->maxEntries = other.maxEntries;
+        this->revalidateIntervalMillis = other.revalidateIntervalMillis;
+        this->useInotify = other.useInotify;
+        return *this;
+    }
+
+    file_cache_config() { }
+
+    file_cache_config(uint32_t maxEntries, uint32_t revalidateIntervalMillis, bool useInotify) :
+    maxEntries(maxEntries),
+    revalidateIntervalMillis(revalidateIntervalMillis),
+    useInotify(useInotify) { }
+
+    file_cache_config(const sl::json::value& json) {
+        for (const sl::json::field& fi : json.as_object()) {
+            auto& name = fi.name();
+            if ("maxEntries" == name) {
+                this->maxEntries = fi.as_uint32_or_throw(name);
+            } else if ("revalidateIntervalMillis" == name) {
+                this->revalidateIntervalMillis = fi.as_uint32_or_throw(name);
+            } else if ("useInotify" == name) {
+                this->useInotify = fi.as_bool_or_throw(name);
+            } else {
+                throw support::exception(TRACEMSG("Unknown 'documentRoot.fileCache' field: [" + name + "]"));
+            }
+        }
+    }
+
+    sl::json::value to_json() const {
+        return {
+            { "maxEntries", maxEntries },
+            { "revalidateIntervalMillis", revalidateIntervalMillis },
+            { "useInotify", useInotify }
+        };
+    }
+
+    bool is_enabled() const {
+        return maxEntries > 0;
+    }
+
+    file_cache_config clone() const {
+        return file_cache_config{maxEntries, revalidateIntervalMillis, useInotify};
+    }
+
+};
+
+} // namespace
+}
+}
+
+#endif /* WILTON_SERVER_CONF_FILE_CACHE_CONFIG_HPP */
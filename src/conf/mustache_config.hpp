@@ -24,6 +24,7 @@
 #ifndef WILTON_SERVER_CONF_MUSTACHE_CONFIG_HPP
 #define WILTON_SERVER_CONF_MUSTACHE_CONFIG_HPP
 
+#include <cstdint>
 #include <string>
 
 #include "staticlib/json.hpp"
@@ -37,16 +38,42 @@ namespace conf {
 class mustache_config {
 public:
     std::vector<std::string> partialsDirs;
+    // templates from these dirs are compiled on startup
+    std::vector<std::string> templateDirs;
+    // bounds for compiled templates used by 'send_mustache'
+    uint32_t cacheMaxEntries = 1024;
+    uint32_t cacheMaxBytes = 16 * 1024 * 1024;
+    // drop changed templates and reload partials automatically
+    bool useInotify = true;
+    // rendered output cache for 'send_mustache', disabled with zero budget
+    uint32_t renderCacheMaxBytes = 0;
+    uint32_t renderCacheTtlMillis = 60000;
+    // outputs up to this size are sent whole from pooled buffers, larger ones are streamed
+    uint32_t renderBufferMaxBytes = 64 * 1024;
 
     mustache_config(const mustache_config&) = delete;
 
     mustache_config& operator=(const mustache_config&) = delete;
 
     mustache_config(mustache_config&& other) :
-    partialsDirs(std::move(other.partialsDirs)) { }
+    partialsDirs(std::move(other.partialsDirs)),
+    templateDirs(std::move(other.templateDirs)),
+    cacheMaxEntries(other.cacheMaxEntries),
+    cacheMaxBytes(other.cacheMaxBytes),
+    useInotify(other.useInotify),
+    renderCacheMaxBytes(other.renderCacheMaxBytes),
+    renderCacheTtlMillis(other.renderCacheTtlMillis),
+    renderBufferMaxBytes(other.renderBufferMaxBytes) { }
 
     mustache_config& operator=(mustache_config&& other) {
         this->partialsDirs = std::move(other.partialsDirs);
+        this->templateDirs = std::move(other.templateDirs);
+        this->cacheMaxEntries = other.cacheMaxEntries;
+        this->cacheMaxBytes = other.cacheMaxBytes;
+        this->useInotify = other.useInotify;
+        this->renderCacheMaxBytes = other.renderCacheMaxBytes;
+        this->renderCacheTtlMillis = other.renderCacheTtlMillis;
+        this->renderBufferMaxBytes = other.renderBufferMaxBytes;
         return *this;
     }
 
@@ -65,6 +92,28 @@ public:
                     }
                     partialsDirs.emplace_back(va.as_string());
                 }
+            } else if ("templateDirs" == name) {
+                for (const sl::json::value& va : fi.as_array_or_throw(name)) {
+                    if (sl::json::type::string != va.json_type() || va.as_string().empty()) {
+                        throw support::exception(TRACEMSG(
+                                "Invalid 'mustache.templateDirs.el' value,"
+                                " type: [" + sl::json::stringify_json_type(va.json_type()) + "]," +
+                                " value: [" + va.dumps() + "]"));
+                    }
+                    templateDirs.emplace_back(va.as_string());
+                }
+            } else if ("cacheMaxEntries" == name) {
+                this->cacheMaxEntries = fi.as_uint32_positive_or_throw(name);
+            } else if ("cacheMaxBytes" == name) {
+                this->cacheMaxBytes = fi.as_uint32_positive_or_throw(name);
+            } else if ("useInotify" == name) {
+                this->useInotify = fi.as_bool_or_throw(name);
+            } else if ("renderCacheMaxBytes" == name) {
+                this->renderCacheMaxBytes = fi.as_uint32_or_throw(name);
+            } else if ("renderCacheTtlMillis" == name) {
+                this->renderCacheTtlMillis = fi.as_uint32_positive_or_throw(name);
+            } else if ("renderBufferMaxBytes" == name) {
+                this->renderBufferMaxBytes = fi.as_uint32_or_throw(name);
             } else {
                 throw support::exception(TRACEMSG("Unknown 'mustache' field: [" + name + "]"));
             }
@@ -78,7 +127,19 @@ public:
                     return sl::json::value(el);
                 });
                 return ra.to_vector();
-            }() }
+            }() },
+            { "templateDirs", [this]{
+                auto ra = sl::ranges::transform(templateDirs, [](const std::string& el) {
+                    return sl::json::value(el);
+                });
+                return ra.to_vector();
+            }() },
+            { "cacheMaxEntries", cacheMaxEntries },
+            { "cacheMaxBytes", cacheMaxBytes },
+            { "useInotify", useInotify },
+            { "renderCacheMaxBytes", renderCacheMaxBytes },
+            { "renderCacheTtlMillis", renderCacheTtlMillis },
+            { "renderBufferMaxBytes", renderBufferMaxBytes }
         };
     }
 };
@@ -40,6 +40,8 @@ public:
     std::string tmpDirPath;
     uint16_t tmpFilenameLength = 32;
     uint32_t memoryLimitBytes = 1048576;
+    // spool file parts of 'multipart/form-data' bodies to 'tmpDirPath' as they arrive
+    bool parseMultipart = false;
 
     request_payload_config(const request_payload_config&) = delete;
 
@@ -48,21 +50,25 @@ public:
     request_payload_config(request_payload_config&& other) :
     tmpDirPath(std::move(other.tmpDirPath)),
     tmpFilenameLength(other.tmpFilenameLength),
-    memoryLimitBytes(other.memoryLimitBytes) { }
+    memoryLimitBytes(other.memoryLimitBytes),
+    parseMultipart(other.parseMultipart) { }
 
     request_payload_config& operator=(request_payload_config&& other) {
         this->tmpDirPath = std::move(other.tmpDirPath);
         this->tmpFilenameLength = other.tmpFilenameLength;
         this->memoryLimitBytes = other.memoryLimitBytes;
+        this->parseMultipart = other.parseMultipart;
         return *this;
     }
 
     request_payload_config() { }
     
-    request_payload_config(const std::string& tmpDirPath, uint16_t tmpFilenameLen, uint32_t memoryLimitBytes) :
+    request_payload_config(const std::string& tmpDirPath, uint16_t tmpFilenameLen, uint32_t memoryLimitBytes,
+            bool parseMultipart = false) :
     tmpDirPath(tmpDirPath.c_str(), tmpDirPath.length()),
     tmpFilenameLength(tmpFilenameLen),
-    memoryLimitBytes(memoryLimitBytes) { }
+    memoryLimitBytes(memoryLimitBytes),
+    parseMultipart(parseMultipart) { }
 
     request_payload_config(const sl::json::value& json) {
         for (const sl::json::field& fi : json.as_object()) {
@@ -73,22 +79,27 @@ public:
                 this->tmpFilenameLength = fi.as_uint16_or_throw(name);
             } else if ("memoryLimitBytes" == name) {
                 this->memoryLimitBytes = fi.as_uint32_or_throw(name);
+            } else if ("parseMultipart" == name) {
+                this->parseMultipart = fi.as_bool_or_throw(name);
             } else {
                 throw support::exception(TRACEMSG("Unknown 'requestPayload' field: [" + name + "]"));
             }
         }
+        if (parseMultipart && tmpDirPath.empty()) throw support::exception(TRACEMSG(
+                "'requestPayload.parseMultipart' requires 'requestPayload.tmpDirPath' to be specified"));
     }
 
     sl::json::value to_json() const {
         return {
             { "tmpDirPath", tmpDirPath },
             { "tmpFilenameLen", tmpFilenameLength },
-            { "memoryLimitBytes", memoryLimitBytes }
+            { "memoryLimitBytes", memoryLimitBytes },
+            { "parseMultipart", parseMultipart }
         };
     }
 
     request_payload_config clone() const {
-        return request_payload_config{tmpDirPath, tmpFilenameLength, memoryLimitBytes};
+        return request_payload_config{tmpDirPath, tmpFilenameLength, memoryLimitBytes, parseMultipart};
     }
     
 };
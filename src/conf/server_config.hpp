@@ -33,6 +33,7 @@
 
 #include "wilton/support/exception.hpp"
 
+#include "conf/asset_cache_config.hpp"
 #include "conf/document_root.hpp"
 #include "conf/mustache_config.hpp"
 #include "conf/request_payload_config.hpp"
@@ -53,6 +54,12 @@ public:
     request_payload_config requestPayload;
     mustache_config mustache;
     std::string root_redirect_location;
+    asset_cache_config assetCache;
+    // zero to read streamed bodies on IO threads
+    uint32_t blockingIoThreads = 2;
+    // budget for resources of 'useResourceLoader' roots, zero disables caching,
+    // 'assetCache' is used for these roots instead when it is enabled
+    uint32_t resourceCacheMaxBytes = 0;
 
     server_config(const server_config&) = delete;
 
@@ -67,7 +74,10 @@ public:
     documentRoots(std::move(other.documentRoots)),
     requestPayload(std::move(other.requestPayload)),
     mustache(std::move(other.mustache)),
-    root_redirect_location(std::move(other.root_redirect_location)) { }
+    root_redirect_location(std::move(other.root_redirect_location)),
+    assetCache(std::move(other.assetCache)),
+    blockingIoThreads(other.blockingIoThreads),
+    resourceCacheMaxBytes(other.resourceCacheMaxBytes) { }
 
     server_config& operator=(server_config&& other) {
         this->numberOfThreads = other.numberOfThreads;
@@ -79,6 +89,9 @@ public:
         this->requestPayload = std::move(other.requestPayload);
         this->mustache = std::move(other.mustache);
         this->root_redirect_location = std::move(other.root_redirect_location);
+        this->assetCache = std::move(other.assetCache);
+        this->blockingIoThreads = other.blockingIoThreads;
+        this->resourceCacheMaxBytes = other.resourceCacheMaxBytes;
         return *this;
     }
 
@@ -106,6 +119,12 @@ public:
                 this->mustache = mustache_config(fi.val());
             } else if ("rootRedirectLocation" == name) {
                 this->root_redirect_location = fi.as_string_nonempty_or_throw(name);
+            } else if ("assetCache" == name) {
+                this->assetCache = asset_cache_config(fi.val());
+            } else if ("blockingIoThreads" == name) {
+                this->blockingIoThreads = fi.as_uint32_or_throw(name);
+            } else if ("resourceCacheMaxBytes" == name) {
+                this->resourceCacheMaxBytes = fi.as_uint32_or_throw(name);
             } else {
                 throw support::exception(TRACEMSG("Unknown field: [" + name + "]"));
             }
@@ -128,6 +147,9 @@ public:
             {"requestPayload", requestPayload.to_json()},
             {"mustache", mustache.to_json()},
             {"rootRedirectLocation", root_redirect_location},
+            {"assetCache", assetCache.to_json()},
+            {"blockingIoThreads", blockingIoThreads},
+            {"resourceCacheMaxBytes", resourceCacheMaxBytes},
         };
     }
 };
@@ -0,0 +1,305 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   dir_watcher.hpp
+ * Author: alex
+ *
+ * Created on October 22, 2026, 11:30 AM
+ */
+
+#ifndef WILTON_SERVER_DIR_WATCHER_HPP
+#define WILTON_SERVER_DIR_WATCHER_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef STATICLIB_LINUX
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // STATICLIB_LINUX
+
+#include "staticlib/config.hpp"
+
+namespace wilton {
+namespace server {
+
+/**
+ * Notifies about changes of files in watched directories using inotify,
+ * callback is called on the watcher thread with directory and file name;
+ * file name is empty if the directory itself is gone, both are empty
+ * if events were lost; callback must not throw; inactive on platforms
+ * other than Linux.
+ *
+ * Watch follows directory inode, so when a directory is renamed or deleted
+ * its watch is dropped, 'watch' call on the same path adds a watch for
+ * the directory that is there now; directories replaced without
+ * an event (e.g. symlink swap) are detected by periodic 'stat' checks
+ */
+class dir_watcher {
+public:
+    using callback_type = std::function<void(const std::string&, const std::string&)>;
+
+private:
+    callback_type callback;
+
+    // directory identity at the moment its watch was added
+    struct dir_watch {
+        int wd;
+        uint64_t dev;
+        uint64_t inode;
+    };
+
+    // interval of checking that watched paths still point to watched directories
+    static const int check_interval_millis = 1000;
+
+    std::mutex mutex;
+    // watch descriptor -> directory
+    std::unordered_map<int, std::string> watches;
+    std::unordered_map<std::string, dir_watch> watched_dirs;
+
+    int inotify_fd = -1;
+    int wakeup_fd = -1;
+    std::atomic<bool> running;
+    std::thread watcher;
+
+public:
+    dir_watcher(callback_type callback) :
+    callback(std::move(callback)),
+    running(false) {
+#ifdef STATICLIB_LINUX
+        inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        wakeup_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (-1 != inotify_fd && -1 != wakeup_fd) {
+            running.store(true, std::memory_order_release);
+            watcher = std::thread([this] {
+                this->watch_loop();
+            });
+        } else {
+            close_fds();
+        }
+#endif // STATICLIB_LINUX
+    }
+
+    dir_watcher(const dir_watcher&) = delete;
+
+    dir_watcher& operator=(const dir_watcher&) = delete;
+
+    ~dir_watcher() STATICLIB_NOEXCEPT {
+#ifdef STATICLIB_LINUX
+        if (running.exchange(false, std::memory_order_acq_rel)) {
+            uint64_t one = 1;
+            auto written = ::write(wakeup_fd, std::addressof(one), sizeof(one));
+            (void) written;
+            watcher.join();
+        }
+#endif // STATICLIB_LINUX
+        close_fds();
+    }
+
+    /**
+     * Starts watching specified directory, repeated calls are no-op
+     * unless the path now points to another directory
+     *
+     * @param dir directory path
+     * @return false if directory cannot be watched
+     */
+    bool watch(const std::string& dir) {
+#ifdef STATICLIB_LINUX
+        if (!running.load(std::memory_order_acquire)) {
+            return false;
+        }
+        struct stat before;
+        if (0 != ::stat(dir.c_str(), std::addressof(before))) {
+            return false;
+        }
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = watched_dirs.find(dir);
+        if (watched_dirs.end() != it) {
+            if (is_same_dir(it->second, before)) {
+                return true;
+            }
+            // directory was replaced, watch follows the old one
+            remove_watch(dir);
+        }
+        int wd = ::inotify_add_watch(inotify_fd, dir.c_str(), IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |
+                IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+        if (-1 == wd) {
+            return false;
+        }
+        if (watches.count(wd) > 0) {
+            // the same directory is already watched under another path
+            return false;
+        }
+        struct stat after;
+        if (0 != ::stat(dir.c_str(), std::addressof(after)) ||
+                after.st_dev != before.st_dev || after.st_ino != before.st_ino) {
+            // replaced while adding, watch may belong to either directory
+            ::inotify_rm_watch(inotify_fd, wd);
+            return false;
+        }
+        auto dw = dir_watch();
+        dw.wd = wd;
+        dw.dev = static_cast<uint64_t>(after.st_dev);
+        dw.inode = static_cast<uint64_t>(after.st_ino);
+        watches[wd] = dir;
+        watched_dirs[dir] = dw;
+        return true;
+#else
+        (void) dir;
+        return false;
+#endif // STATICLIB_LINUX
+    }
+
+private:
+    void watch_loop() {
+#ifdef STATICLIB_LINUX
+        // aligned as required by 'inotify_event'
+        alignas(struct inotify_event) char buf[4096];
+        auto events = std::vector<std::pair<std::string, std::string>>();
+        auto last_check = std::chrono::steady_clock::now();
+        while (running.load(std::memory_order_acquire)) {
+            struct pollfd fds[2];
+            fds[0].fd = inotify_fd;
+            fds[0].events = POLLIN;
+            fds[1].fd = wakeup_fd;
+            fds[1].events = POLLIN;
+            int ready = ::poll(fds, 2, check_interval_millis);
+            if (ready < 0) continue;
+            if (0 != (fds[1].revents & POLLIN)) break;
+            events.clear();
+            if (0 != (fds[0].revents & POLLIN)) {
+                auto len = ::read(inotify_fd, buf, sizeof(buf));
+                std::lock_guard<std::mutex> guard{mutex};
+                for (char* ptr = buf; len > 0 && ptr < buf + len;) {
+                    auto ev = reinterpret_cast<struct inotify_event*>(ptr);
+                    collect_event(*ev, events);
+                    ptr += sizeof(struct inotify_event) + ev->len;
+                }
+            }
+            auto now = std::chrono::steady_clock::now();
+            if (now - last_check >= std::chrono::milliseconds(static_cast<int64_t>(check_interval_millis))) {
+                collect_replaced(events);
+                last_check = now;
+            }
+            // called without the lock, so callback may add watches
+            for (auto& pa : events) {
+                callback(pa.first, pa.second);
+            }
+        }
+#endif // STATICLIB_LINUX
+    }
+
+#ifdef STATICLIB_LINUX
+    // must be called under lock
+    void collect_event(const struct inotify_event& ev, std::vector<std::pair<std::string, std::string>>& events) {
+        if (0 != (ev.mask & IN_Q_OVERFLOW)) {
+            events.emplace_back(std::string(), std::string());
+            return;
+        }
+        auto it = watches.find(ev.wd);
+        if (watches.end() == it) {
+            return;
+        }
+        if (0 != (ev.mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))) {
+            // watch is dropped, so the next 'watch' call on this path
+            // adds a watch for the directory that replaces this one
+            auto dir = it->second;
+            remove_watch(dir);
+            events.emplace_back(std::move(dir), std::string());
+            return;
+        }
+        if (ev.len > 0) {
+            auto name = std::string(ev.name);
+            // single write usually produces several events for the same file
+            if (events.empty() || events.back().first != it->second || events.back().second != name) {
+                events.emplace_back(it->second, std::move(name));
+            }
+        }
+    }
+
+    // paths are checked without the lock
+    void collect_replaced(std::vector<std::pair<std::string, std::string>>& events) {
+        auto list = std::vector<std::pair<std::string, dir_watch>>();
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            for (auto& pa : watched_dirs) {
+                list.emplace_back(pa.first, pa.second);
+            }
+        }
+        for (auto& pa : list) {
+            struct stat st;
+            if (0 == ::stat(pa.first.c_str(), std::addressof(st)) && is_same_dir(pa.second, st)) {
+                continue;
+            }
+            std::lock_guard<std::mutex> guard{mutex};
+            auto it = watched_dirs.find(pa.first);
+            if (watched_dirs.end() != it && it->second.wd == pa.second.wd) {
+                remove_watch(pa.first);
+                events.emplace_back(pa.first, std::string());
+            }
+        }
+    }
+
+    // must be called under lock
+    void remove_watch(const std::string& dir) {
+        auto it = watched_dirs.find(dir);
+        if (watched_dirs.end() == it) {
+            return;
+        }
+        int wd = it->second.wd;
+        // 'IN_IGNORED' for this descriptor is skipped as it is not in 'watches' anymore
+        ::inotify_rm_watch(inotify_fd, wd);
+        watches.erase(wd);
+        watched_dirs.erase(it);
+    }
+
+    static bool is_same_dir(const dir_watch& dw, const struct stat& st) {
+        return dw.dev == static_cast<uint64_t>(st.st_dev) &&
+                dw.inode == static_cast<uint64_t>(st.st_ino);
+    }
+#endif // STATICLIB_LINUX
+
+    void close_fds() STATICLIB_NOEXCEPT {
+#ifdef STATICLIB_LINUX
+        if (-1 != inotify_fd) {
+            ::close(inotify_fd);
+            inotify_fd = -1;
+        }
+        if (-1 != wakeup_fd) {
+            ::close(wakeup_fd);
+            wakeup_fd = -1;
+        }
+#endif // STATICLIB_LINUX
+    }
+
+};
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_DIR_WATCHER_HPP */
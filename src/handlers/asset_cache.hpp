@@ -0,0 +1,186 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   asset_cache.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 3:25 PM
+ */
+
+#ifndef WILTON_SERVER_HANDLERS_ASSET_CACHE_HPP
+#define WILTON_SERVER_HANDLERS_ASSET_CACHE_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "staticlib/json.hpp"
+
+#include "conf/asset_cache_config.hpp"
+
+namespace wilton {
+namespace server {
+namespace handlers {
+
+/**
+ * Server-wide cache of small response bodies shared by document root
+ * handlers, entries are immutable and are shared between IO threads
+ * without copying; each entry is stored along with the validator
+ * (e.g. ETag) of its source, stale entries are dropped on lookup
+ */
+class asset_cache {
+    // (hits, sequence) for LFU, (sequence, 0) for LRU, smallest is evicted first
+    using priority_type = std::pair<uint64_t, uint64_t>;
+
+    class entry {
+    public:
+        std::string validator;
+        std::shared_ptr<const std::string> body;
+        uint64_t hits = 0;
+        priority_type priority;
+
+        entry(const std::string& validator, std::shared_ptr<const std::string> body) :
+        validator(validator.data(), validator.length()),
+        body(std::move(body)) { }
+    };
+
+    server::conf::asset_cache_config conf;
+    bool lfu;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, entry> entries;
+    std::map<priority_type, std::string> eviction_order;
+    uint64_t sequence = 0;
+    uint64_t bytes = 0;
+
+    uint64_t hits_count = 0;
+    uint64_t misses_count = 0;
+    uint64_t evictions_count = 0;
+
+public:
+    asset_cache(const server::conf::asset_cache_config& conf) :
+    conf(conf.clone()),
+    lfu("LFU" == conf.evictionPolicy) { }
+
+    asset_cache(const asset_cache&) = delete;
+
+    asset_cache& operator=(const asset_cache&) = delete;
+
+    /**
+     * Checks whether body of the specified size can be cached
+     *
+     * @param size body size
+     * @return true if body is not larger than the entry limit
+     */
+    bool admits(uint64_t size) const {
+        return size <= conf.maxEntryBytes && size <= conf.maxBytes;
+    }
+
+    /**
+     * Looks up cached body
+     *
+     * @param key cache key
+     * @param validator current validator of the source
+     * @return cached body or null if it is absent or stale
+     */
+    std::shared_ptr<const std::string> get(const std::string& key, const std::string& validator) {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = entries.find(key);
+        if (entries.end() == it) {
+            misses_count += 1;
+            return std::shared_ptr<const std::string>();
+        }
+        auto& en = it->second;
+        if (validator != en.validator) {
+            misses_count += 1;
+            erase_entry(it);
+            return std::shared_ptr<const std::string>();
+        }
+        hits_count += 1;
+        en.hits += 1;
+        eviction_order.erase(en.priority);
+        en.priority = next_priority(en.hits);
+        eviction_order.emplace(en.priority, key);
+        return en.body;
+    }
+
+    /**
+     * Adds body to cache evicting other entries to fit into byte budget
+     *
+     * @param key cache key
+     * @param validator current validator of the source
+     * @param body body to cache
+     */
+    void put(const std::string& key, const std::string& validator, std::shared_ptr<const std::string> body) {
+        if (!admits(body->length())) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard{mutex};
+        auto existing = entries.find(key);
+        if (entries.end() != existing) {
+            erase_entry(existing);
+        }
+        while (bytes + body->length() > conf.maxBytes && !eviction_order.empty()) {
+            erase_entry(entries.find(eviction_order.begin()->second));
+            evictions_count += 1;
+        }
+        bytes += body->length();
+        auto pa = entries.emplace(key, entry(validator, std::move(body)));
+        auto& en = pa.first->second;
+        en.priority = next_priority(0);
+        eviction_order.emplace(en.priority, key);
+    }
+
+    sl::json::value stats() {
+        std::lock_guard<std::mutex> guard{mutex};
+        return {
+            { "hits", hits_count },
+            { "misses", misses_count },
+            { "evictions", evictions_count },
+            { "entries", static_cast<uint64_t>(entries.size()) },
+            { "bytes", bytes }
+        };
+    }
+
+private:
+    // must be called under lock
+    priority_type next_priority(uint64_t hits) {
+        sequence += 1;
+        if (lfu) {
+            return priority_type(hits, sequence);
+        }
+        return priority_type(sequence, 0);
+    }
+
+    // must be called under lock
+    void erase_entry(std::unordered_map<std::string, entry>::iterator it) {
+        bytes -= it->second.body->length();
+        eviction_order.erase(it->second.priority);
+        entries.erase(it);
+    }
+
+};
+
+} // namespace
+}
+}
+
+#endif /* WILTON_SERVER_HANDLERS_ASSET_CACHE_HPP */
@@ -0,0 +1,454 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   file_cache.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 1:20 PM
+ */
+
+#ifndef WILTON_SERVER_HANDLERS_FILE_CACHE_HPP
+#define WILTON_SERVER_HANDLERS_FILE_CACHE_HPP
+
+#include <cstdint>
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#ifdef STATICLIB_LINUX
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // STATICLIB_LINUX
+
+#include "staticlib/config.hpp"
+
+#include "conf/file_cache_config.hpp"
+#include "native_file.hpp"
+
+namespace wilton {
+namespace server {
+namespace handlers {
+
+/**
+ * Bounded LRU cache of opened document root files (and of the misses
+ * of optional files, like precompressed siblings), entries are dropped
+ * on inotify events for their parent directories, entries that are not
+ * covered by inotify are re-checked with 'stat' after the configured interval;
+ * inotify follows directory inode, not its path, so identity of watched
+ * directories is re-checked after the same interval to detect renames
+ * and symlink swaps of the directory or its parents; directory watch
+ * is dropped together with the last cached entry of that directory
+ */
+class file_cache {
+    class entry {
+    public:
+        // null for the cached misses
+        std::shared_ptr<native_file> file;
+        uint64_t checked_at_millis;
+        bool watched;
+        std::list<std::string>::iterator lru_pos;
+
+        entry(std::shared_ptr<native_file> file, uint64_t checked_at_millis, bool watched) :
+        file(std::move(file)),
+        checked_at_millis(checked_at_millis),
+        watched(watched) { }
+    };
+
+    server::conf::file_cache_config conf;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, entry> entries;
+    // most recently used first
+    std::list<std::string> lru;
+    class dir_watch {
+    public:
+        int wd;
+        uint64_t dev;
+        uint64_t inode;
+        uint64_t checked_at_millis;
+        // watch is dropped when the last entry of the directory is erased
+        size_t entries_count = 0;
+
+        dir_watch(int wd, uint64_t dev, uint64_t inode, uint64_t checked_at_millis) :
+        wd(wd),
+        dev(dev),
+        inode(inode),
+        checked_at_millis(checked_at_millis) { }
+    };
+
+    // watch descriptor -> directory
+    std::unordered_map<int, std::string> watches;
+    std::unordered_map<std::string, dir_watch> watched_dirs;
+    // incremented on every inotify event
+    uint64_t generation = 0;
+
+    int inotify_fd = -1;
+    int wakeup_fd = -1;
+    std::atomic<bool> running;
+    std::thread watcher;
+
+public:
+    file_cache(const server::conf::file_cache_config& conf) :
+    conf(conf.clone()),
+    running(false) {
+#ifdef STATICLIB_LINUX
+        if (this->conf.useInotify) {
+            inotify_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+            wakeup_fd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+            if (-1 != inotify_fd && -1 != wakeup_fd) {
+                running.store(true, std::memory_order_release);
+                watcher = std::thread([this] {
+                    this->watch_loop();
+                });
+            } else {
+                // revalidation by interval will be used
+                close_fds();
+            }
+        }
+#endif // STATICLIB_LINUX
+    }
+
+    file_cache(const file_cache&) = delete;
+
+    file_cache& operator=(const file_cache&) = delete;
+
+    ~file_cache() STATICLIB_NOEXCEPT {
+#ifdef STATICLIB_LINUX
+        if (running.exchange(false, std::memory_order_acq_rel)) {
+            uint64_t one = 1;
+            auto written = ::write(wakeup_fd, std::addressof(one), sizeof(one));
+            (void) written;
+            watcher.join();
+        }
+#endif // STATICLIB_LINUX
+        close_fds();
+    }
+
+    /**
+     * Returns cached or newly opened file
+     *
+     * @param path file path
+     * @param cache_missing whether to remember that the file does not exist,
+     *        intended for the probes of optional files
+     * @return opened file or null if file cannot be opened or is a directory
+     */
+    std::shared_ptr<native_file> open(const std::string& path, bool cache_missing = false) {
+        auto now = current_millis();
+        std::shared_ptr<native_file> cached;
+        bool found = false;
+        bool check_dir = false;
+        uint64_t gen = 0;
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            gen = generation;
+            auto it = entries.find(path);
+            if (entries.end() != it) {
+                auto& en = it->second;
+                lru.splice(lru.begin(), lru, en.lru_pos);
+                if (now - en.checked_at_millis < conf.revalidateIntervalMillis) {
+                    return en.file;
+                }
+                if (en.watched) {
+                    auto dw = watched_dirs.find(dir_of(path));
+                    if (watched_dirs.end() != dw && now - dw->second.checked_at_millis < conf.revalidateIntervalMillis) {
+                        return en.file;
+                    }
+                    check_dir = true;
+                }
+                cached = en.file;
+                found = true;
+            }
+        }
+        if (check_dir && is_watch_current(dir_of(path), now)) {
+            return cached;
+        }
+        if (found && nullptr == cached.get() && !native_file::stat(path).exists) {
+            std::lock_guard<std::mutex> guard{mutex};
+            auto it = entries.find(path);
+            if (entries.end() != it && nullptr == it->second.file.get()) {
+                it->second.checked_at_millis = now;
+            }
+            return cached;
+        }
+        if (nullptr != cached.get() && is_unchanged(path, *cached)) {
+            std::lock_guard<std::mutex> guard{mutex};
+            auto it = entries.find(path);
+            if (entries.end() != it && it->second.file == cached) {
+                it->second.checked_at_millis = now;
+            }
+            return cached;
+        }
+        // open outside of the lock
+        auto file = native_file::open(path);
+        std::lock_guard<std::mutex> guard{mutex};
+        erase_entry(path);
+        // file may have been replaced while it was being opened
+        bool cacheable = nullptr != file.get() ? file->is_regular_file() : cache_missing;
+        if (cacheable && gen == generation) {
+            bool watched = add_watch(path);
+            lru.push_front(path);
+            auto pa = entries.emplace(path, entry(file, now, watched));
+            pa.first->second.lru_pos = lru.begin();
+            while (entries.size() > conf.maxEntries) {
+                erase_entry(lru.back());
+            }
+        }
+        return file;
+    }
+
+private:
+    static uint64_t current_millis() {
+        auto dur = std::chrono::steady_clock::now().time_since_epoch();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(dur).count());
+    }
+
+    static bool is_unchanged(const std::string& path, const native_file& file) {
+        auto info = native_file::stat(path);
+        return info.exists && info.inode == file.inode() &&
+                info.size == file.size() && info.mtime == file.mtime();
+    }
+
+    // must be called under lock
+    void erase_entry(const std::string& path) {
+        auto it = entries.find(path);
+        if (entries.end() != it) {
+            bool watched = it->second.watched;
+            lru.erase(it->second.lru_pos);
+            entries.erase(it);
+            if (watched) {
+                release_watch(dir_of(path));
+            }
+        }
+    }
+
+    // checks that watch of the directory still follows the inode found by its path,
+    // stale watch is removed together with its entries
+    bool is_watch_current(const std::string& dir, uint64_t now) {
+#ifdef STATICLIB_LINUX
+        struct stat st;
+        bool found = 0 == ::stat(dir.c_str(), std::addressof(st));
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = watched_dirs.find(dir);
+        if (watched_dirs.end() == it) {
+            return false;
+        }
+        if (found && static_cast<uint64_t>(st.st_dev) == it->second.dev &&
+                static_cast<uint64_t>(st.st_ino) == it->second.inode) {
+            it->second.checked_at_millis = now;
+            return true;
+        }
+        remove_watch(dir);
+        return false;
+#else
+        (void) dir;
+        (void) now;
+        return false;
+#endif // STATICLIB_LINUX
+    }
+
+    // must be called under lock
+    bool add_watch(const std::string& path) {
+#ifdef STATICLIB_LINUX
+        if (!running.load(std::memory_order_acquire)) {
+            return false;
+        }
+        auto dir = dir_of(path);
+        struct stat before;
+        if (0 != ::stat(dir.c_str(), std::addressof(before))) {
+            return false;
+        }
+        auto it = watched_dirs.find(dir);
+        if (watched_dirs.end() != it) {
+            if (static_cast<uint64_t>(before.st_dev) == it->second.dev &&
+                    static_cast<uint64_t>(before.st_ino) == it->second.inode) {
+                it->second.entries_count += 1;
+                return true;
+            }
+            // directory was replaced, old watch follows the old inode
+            remove_watch(dir);
+        }
+        int wd = ::inotify_add_watch(inotify_fd, dir.c_str(), IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE |
+                IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+        if (-1 == wd) {
+            // watches limit reached, fall back to revalidation
+            return false;
+        }
+        if (watches.count(wd) > 0) {
+            // same inode is already watched under another path
+            return false;
+        }
+        struct stat after;
+        if (0 != ::stat(dir.c_str(), std::addressof(after)) ||
+                after.st_dev != before.st_dev || after.st_ino != before.st_ino) {
+            // replaced while the watch was being added
+            ::inotify_rm_watch(inotify_fd, wd);
+            return false;
+        }
+        watches[wd] = dir;
+        auto pa = watched_dirs.emplace(dir, dir_watch(wd, static_cast<uint64_t>(after.st_dev),
+                static_cast<uint64_t>(after.st_ino), current_millis()));
+        pa.first->second.entries_count = 1;
+        return true;
+#else
+        (void) path;
+        return false;
+#endif // STATICLIB_LINUX
+    }
+
+    // must be called under lock
+    void remove_watch(const std::string& dir) {
+#ifdef STATICLIB_LINUX
+        erase_dir_entries(dir);
+        auto it = watched_dirs.find(dir);
+        if (watched_dirs.end() != it) {
+            drop_watch(it);
+        }
+#else
+        (void) dir;
+#endif // STATICLIB_LINUX
+    }
+
+    // must be called under lock
+    void release_watch(const std::string& dir) {
+        auto it = watched_dirs.find(dir);
+        if (watched_dirs.end() == it) {
+            return;
+        }
+        it->second.entries_count -= 1;
+        if (0 == it->second.entries_count) {
+            drop_watch(it);
+        }
+    }
+
+    // must be called under lock
+    void drop_watch(std::unordered_map<std::string, dir_watch>::iterator it) {
+#ifdef STATICLIB_LINUX
+        ::inotify_rm_watch(inotify_fd, it->second.wd);
+#endif // STATICLIB_LINUX
+        watches.erase(it->second.wd);
+        watched_dirs.erase(it);
+    }
+
+    // must be called under lock, watch of the directory is left to the caller
+    void erase_dir_entries(const std::string& dir) {
+        for (auto en = entries.begin(); en != entries.end();) {
+            if (dir == dir_of(en->first)) {
+                lru.erase(en->second.lru_pos);
+                en = entries.erase(en);
+            } else {
+                ++en;
+            }
+        }
+    }
+
+    static std::string dir_of(const std::string& path) {
+        auto pos = path.rfind('/');
+        if (std::string::npos == pos) {
+            return std::string(".");
+        }
+        return path.substr(0, pos);
+    }
+
+    // inverse of 'dir_of', keeps paths in the same form as cache keys
+    static std::string join_path(const std::string& dir, const std::string& name) {
+        if ("." == dir) {
+            return name;
+        }
+        return dir + "/" + name;
+    }
+
+    void watch_loop() {
+#ifdef STATICLIB_LINUX
+        // aligned as required by 'inotify_event'
+        alignas(struct inotify_event) char buf[4096];
+        while (running.load(std::memory_order_acquire)) {
+            struct pollfd fds[2];
+            fds[0].fd = inotify_fd;
+            fds[0].events = POLLIN;
+            fds[1].fd = wakeup_fd;
+            fds[1].events = POLLIN;
+            if (::poll(fds, 2, -1) <= 0) continue;
+            if (0 != (fds[1].revents & POLLIN)) break;
+            auto len = ::read(inotify_fd, buf, sizeof(buf));
+            if (len <= 0) continue;
+            std::lock_guard<std::mutex> guard{mutex};
+            generation += 1;
+            for (char* ptr = buf; ptr < buf + len;) {
+                auto ev = reinterpret_cast<struct inotify_event*>(ptr);
+                handle_event(*ev);
+                ptr += sizeof(struct inotify_event) + ev->len;
+            }
+        }
+#endif // STATICLIB_LINUX
+    }
+
+#ifdef STATICLIB_LINUX
+    // must be called under lock
+    void handle_event(const struct inotify_event& ev) {
+        if (0 != (ev.mask & IN_Q_OVERFLOW)) {
+            entries.clear();
+            lru.clear();
+            while (!watched_dirs.empty()) {
+                drop_watch(watched_dirs.begin());
+            }
+            return;
+        }
+        auto it = watches.find(ev.wd);
+        if (watches.end() == it) {
+            return;
+        }
+        if (0 != (ev.mask & (IN_IGNORED | IN_DELETE_SELF | IN_MOVE_SELF))) {
+            // directory itself is gone, its entries cannot be tracked anymore,
+            // watch is removed so the new directory at the same path gets its own
+            auto dir = it->second;
+            remove_watch(dir);
+            return;
+        }
+        if (ev.len > 0) {
+            erase_entry(join_path(it->second, std::string(ev.name)));
+        }
+    }
+#endif // STATICLIB_LINUX
+
+    void close_fds() STATICLIB_NOEXCEPT {
+#ifdef STATICLIB_LINUX
+        if (-1 != inotify_fd) {
+            ::close(inotify_fd);
+            inotify_fd = -1;
+        }
+        if (-1 != wakeup_fd) {
+            ::close(wakeup_fd);
+            wakeup_fd = -1;
+        }
+#endif // STATICLIB_LINUX
+    }
+
+};
+
+} // namespace
+}
+}
+
+#endif /* WILTON_SERVER_HANDLERS_FILE_CACHE_HPP */
@@ -25,6 +25,7 @@
 #define WILTON_SERVER_HANDLERS_FILE_HANDLER_HPP
 
 #include <cstdint>
+#include <array>
 #include <memory>
 #include <streambuf>
 #include <string>
@@ -38,8 +39,15 @@
 
 #include "wilton/support/exception.hpp"
 
+#include "blocking_io_pool.hpp"
 #include "conf/document_root.hpp"
+#include "handlers/asset_cache.hpp"
+#include "handlers/file_cache.hpp"
 #include "handlers/handlers_common.hpp"
+#include "http_conditional.hpp"
+#include "native_file.hpp"
+#include "response_file_sender.hpp"
+#include "response_memory_sender.hpp"
 #include "response_stream_sender.hpp"
 
 namespace wilton {
@@ -62,25 +70,79 @@ sl::support::optional<sl::tinydir::file_source> open_file_source(const std::stri
     }
 }
 
+class precompressed_encoding {
+public:
+    const char* coding;
+    const char* extension;
+};
+
+// in order of preference
+const std::array<precompressed_encoding, 2> precompressed_encodings = {{
+    {"br", ".br"},
+    {"gzip", ".gz"}
+}};
+
+std::shared_ptr<const std::string> read_whole_file(native_file& file, uint64_t size) {
+    auto res = std::make_shared<std::string>();
+    res->resize(static_cast<size_t>(size));
+    uint64_t pos = 0;
+    while (pos < size) {
+        auto read = file.read_at({std::addressof(res->front()) + pos, static_cast<size_t>(size - pos)}, pos);
+        if (read <= 0) {
+            // truncated concurrently
+            return std::shared_ptr<const std::string>();
+        }
+        pos += static_cast<uint64_t>(read);
+    }
+    return std::move(res);
+}
+
+// file metadata, descriptor is present only when it was taken from the file cache
+class native_target {
+public:
+    native_file_info info;
+    std::shared_ptr<native_file> file;
+};
+
 } // namespace
 
 class file_handler {
     std::shared_ptr<server::conf::document_root> conf;
+    std::shared_ptr<document_root_headers> headers;
+    std::shared_ptr<file_cache> cache;
+    std::shared_ptr<asset_cache> assets;
+    std::shared_ptr<blocking_io_pool> io_pool;
 
 public:
     // must be copyable to satisfy std::function
     file_handler(const file_handler& other) :
-    conf(other.conf) { }
+    conf(other.conf),
+    headers(other.headers),
+    cache(other.cache),
+    assets(other.assets),
+    io_pool(other.io_pool) { }
 
     file_handler& operator=(const file_handler& other) {
         this->conf = other.conf;
+        this->headers = other.headers;
+        this->cache = other.cache;
+        this->assets = other.assets;
+        this->io_pool = other.io_pool;
         return *this;
     }
 
-    file_handler(const server::conf::document_root& conf) :
-    conf(std::make_shared<server::conf::document_root>(conf.clone())) {
+    file_handler(const server::conf::document_root& conf,
+            std::shared_ptr<asset_cache> assets = std::shared_ptr<asset_cache>(),
+            std::shared_ptr<blocking_io_pool> io_pool = std::shared_ptr<blocking_io_pool>()) :
+    conf(std::make_shared<server::conf::document_root>(conf.clone())),
+    headers(std::make_shared<document_root_headers>(conf)),
+    assets(std::move(assets)),
+    io_pool(std::move(io_pool)) {
         if (0 == this->conf->dirPath.length()) throw support::exception(TRACEMSG(
                 "Invalid empty 'dirPath' specified"));
+        if (this->conf->fileCache.is_enabled() && native_file::is_supported()) {
+            this->cache = std::make_shared<file_cache>(this->conf->fileCache);
+        }
     }
 
     // note: it may be better to add some pre-checks to the supplied file path
@@ -91,18 +153,159 @@ public:
             send400(std::move(resp), url_path);
         } else {
             std::string file_path = std::string(conf->dirPath) + "/" + url_path;
-            auto fd_opt = open_file_source(file_path);
-            if (fd_opt.has_value()) {
-                auto fd_ptr = sl::io::make_source_istream_ptr(std::move(fd_opt.value()));
-                set_response_headers(*conf, url_path, resp->get_response());
-                auto sender = sl::support::make_unique<response_stream_sender>(std::move(resp), std::move(fd_ptr));
-                sender->send(std::move(sender));
+            if (native_file::is_supported()) {
+                send_native(*req, std::move(resp), url_path, file_path);
             } else {
-                send404(std::move(resp), url_path);
+                send_stream(std::move(resp), url_path, file_path, "HEAD" == req->get_method());
             }
         }
     }
 
+private:
+    // file is opened only when the body is sent, validators,
+    // '304' and 'HEAD' responses use metadata from 'stat'
+    void send_native(const sl::pion::http_request& req, sl::pion::response_writer_ptr resp,
+            const std::string& url_path, const std::string& file_path) {
+        auto target = find_native(file_path);
+        if (!target.info.exists) {
+            send404(std::move(resp), url_path);
+            return;
+        }
+        if (!target.info.regular) {
+            // pipes and devices cannot be read positionally
+            send_stream(std::move(resp), url_path, file_path, "HEAD" == req.get_method());
+            return;
+        }
+        auto& rp = resp->get_response();
+        set_response_headers(*headers, url_path, rp);
+        auto served_path = file_path;
+        if (conf->servePrecompressed) {
+            rp.change_header("Vary", "Accept-Encoding");
+            const std::string& accepted = req.get_header("Accept-Encoding");
+            for (auto& en : precompressed_encodings) {
+                if (!accepts_encoding(accepted, en.coding)) continue;
+                // sibling misses are cached as well
+                auto sibling = find_native(file_path + en.extension, true);
+                if (sibling.info.exists && sibling.info.regular) {
+                    target = std::move(sibling);
+                    served_path += en.extension;
+                    rp.change_header("Content-Encoding", en.coding);
+                    break;
+                }
+            }
+        }
+        auto& info = target.info;
+        auto etag = make_file_etag(info.inode, info.size, info.mtime);
+        auto last_modified = format_http_date(info.mtime);
+        set_validator_headers(rp, etag, last_modified);
+        if (is_not_modified(req, etag, info.mtime)) {
+            send304(std::move(resp));
+            return;
+        }
+        auto size = info.size;
+        if ("HEAD" == req.get_method()) {
+            rp.change_header("Accept-Ranges", "bytes");
+            send_head(std::move(resp), size);
+            return;
+        }
+        if (nullptr != assets.get() && assets->admits(size) && req.get_header("Range").empty()) {
+            auto body = assets->get(served_path, etag);
+            if (nullptr == body.get() && open_target(rp, served_path, target, etag, last_modified)) {
+                size = target.info.size;
+                body = read_whole_file(*target.file, size);
+                if (nullptr != body.get()) {
+                    assets->put(served_path, etag, body);
+                }
+            }
+            if (nullptr != body.get()) {
+                rp.change_header("Accept-Ranges", "bytes");
+                auto sender = sl::support::make_unique<response_memory_sender>(std::move(resp), std::move(body));
+                sender->send(std::move(sender));
+                return;
+            }
+        }
+        if (!open_target(rp, served_path, target, etag, last_modified)) {
+            clear_file_headers(rp);
+            send404(std::move(resp), url_path);
+            return;
+        }
+        size = target.info.size;
+        send_native_file(req, std::move(resp), std::move(target.file), 0, size, etag, last_modified,
+                [](bool){}, io_pool);
+    }
+
+    native_target find_native(const std::string& file_path, bool optional = false) {
+        auto res = native_target();
+        if (nullptr != cache.get()) {
+            // cached descriptors carry their metadata, only misses are opened
+            res.file = cache->open(file_path, optional);
+            if (nullptr != res.file.get()) {
+                res.info.exists = true;
+                res.info.regular = res.file->is_regular_file();
+                res.info.size = res.file->size();
+                res.info.mtime = res.file->mtime();
+                res.info.inode = res.file->inode();
+            }
+            return res;
+        }
+        res.info = native_file::stat(file_path);
+        return res;
+    }
+
+    // opens the file found with 'stat', validators are updated
+    // if the file was replaced after 'stat'
+    bool open_target(sl::pion::http_response& rp, const std::string& served_path, native_target& target,
+            std::string& etag, std::string& last_modified) {
+        if (nullptr != target.file.get()) {
+            return true;
+        }
+        auto file = native_file::open(served_path);
+        if (nullptr == file.get() || !file->is_regular_file()) {
+            return false;
+        }
+        auto& info = target.info;
+        if (file->inode() != info.inode || file->size() != info.size || file->mtime() != info.mtime) {
+            info.size = file->size();
+            info.mtime = file->mtime();
+            info.inode = file->inode();
+            etag = make_file_etag(info.inode, info.size, info.mtime);
+            last_modified = format_http_date(info.mtime);
+            set_validator_headers(rp, etag, last_modified);
+        }
+        target.file = std::move(file);
+        return true;
+    }
+
+    // file was removed after 'stat', headers describing it
+    // and its precompressed sibling must not go with '404'
+    static void clear_file_headers(sl::pion::http_response& rp) {
+        rp.delete_header("Content-Type");
+        rp.delete_header("Cache-Control");
+        rp.delete_header("Content-Encoding");
+        rp.delete_header("Vary");
+        rp.delete_header("ETag");
+        rp.delete_header("Last-Modified");
+        rp.delete_header("Accept-Ranges");
+    }
+
+    void send_stream(sl::pion::response_writer_ptr resp, const std::string& url_path,
+            const std::string& file_path, bool head_only) {
+        auto fd_opt = open_file_source(file_path);
+        if (fd_opt.has_value()) {
+            set_response_headers(*headers, url_path, resp->get_response());
+            if (head_only) {
+                send_head(std::move(resp), native_file::stat(file_path).size);
+                return;
+            }
+            auto fd_ptr = sl::io::make_source_istream_ptr(std::move(fd_opt.value()));
+            auto sender = sl::support::make_unique<response_stream_sender>(std::move(resp), std::move(fd_ptr),
+                    [](bool){}, io_pool);
+            sender->send(std::move(sender));
+        } else {
+            send404(std::move(resp), url_path);
+        }
+    }
+
 };
 
 } // namespace
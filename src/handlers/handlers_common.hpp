@@ -24,7 +24,15 @@
 #ifndef WILTON_SERVER_HANDLERS_HANDLERS_COMMON_HPP
 #define WILTON_SERVER_HANDLERS_HANDLERS_COMMON_HPP
 
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
 #include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "staticlib/config.hpp"
 #include "staticlib/json.hpp"
@@ -41,43 +49,175 @@ namespace wilton {
 namespace server {
 namespace handlers {
 
-inline void set_response_headers(const server::conf::document_root& conf, 
-        const std::string& url_path, sl::pion::http_response& resp) {
-    auto ct = std::string("application/octet-stream");
-    for (const auto& mi : conf.mimeTypes) {
-        if (sl::utils::ends_with(url_path, mi.extension)) {
-            ct = mi.mime;
-            break;
+/**
+ * Response headers of a document root compiled once on startup,
+ * MIME types are looked up by the extension after the last dot,
+ * other configured suffixes are checked with 'ends_with'; as with
+ * the linear lookup, first matching 'mimeTypes' entry wins
+ */
+class document_root_headers {
+    // extension -> position in 'mimeTypes' and MIME type
+    std::unordered_map<std::string, std::pair<size_t, std::string>> mimes_by_extension;
+    // position, suffix and MIME type in configured order
+    std::vector<std::tuple<size_t, std::string, std::string>> suffix_mimes;
+    std::string default_mime = "application/octet-stream";
+    std::string cache_control;
+
+public:
+    document_root_headers(const server::conf::document_root& conf) :
+    cache_control("max-age=" + sl::support::to_string(conf.cacheMaxAgeSeconds) + ", public") {
+        size_t position = 0;
+        for (const auto& mi : conf.mimeTypes) {
+            // only "." followed by a single extension can be looked up by the last dot
+            if (mi.extension.length() > 1 && '.' == mi.extension.front() &&
+                    std::string::npos == mi.extension.find('.', 1)) {
+                mimes_by_extension.emplace(mi.extension.substr(1), std::make_pair(position, mi.mime));
+            } else {
+                suffix_mimes.emplace_back(position, mi.extension, mi.mime);
+            }
+            position += 1;
+        }
+    }
+
+    document_root_headers(const document_root_headers&) = delete;
+
+    document_root_headers& operator=(const document_root_headers&) = delete;
+
+    const std::string& content_type(const std::string& url_path) const {
+        const std::string* found = std::addressof(default_mime);
+        size_t found_position = std::numeric_limits<size_t>::max();
+        auto dot = url_path.rfind('.');
+        if (std::string::npos != dot) {
+            auto it = mimes_by_extension.find(url_path.substr(dot + 1));
+            if (mimes_by_extension.end() != it) {
+                found = std::addressof(it->second.second);
+                found_position = it->second.first;
+            }
+        }
+        // only suffixes configured before the found extension can win
+        for (const auto& en : suffix_mimes) {
+            if (std::get<0>(en) > found_position) {
+                break;
+            }
+            if (sl::utils::ends_with(url_path, std::get<1>(en))) {
+                return std::get<2>(en);
+            }
+        }
+        return *found;
+    }
+
+    const std::string& cache_control_value() const {
+        return cache_control;
+    }
+};
+
+/**
+ * JSON error body serialized once, only the path
+ * is serialized for each response
+ */
+class json_error_body {
+    std::string prefix;
+    std::string suffix;
+
+public:
+    json_error_body(uint16_t code, const std::string& message) {
+        const std::string placeholder = "__wilton_path__";
+        auto full = sl::json::dumps({
+            {"error", {
+                { "code", code },
+                { "message", message },
+                { "path", placeholder }}}
+        });
+        auto quoted = "\"" + placeholder + "\"";
+        auto pos = full.find(quoted);
+        prefix = full.substr(0, pos);
+        suffix = full.substr(pos + quoted.length());
+    }
+
+    json_error_body(const json_error_body&) = delete;
+
+    json_error_body& operator=(const json_error_body&) = delete;
+
+    std::string render(const std::string& path) const {
+        return prefix + sl::json::value(path).dumps() + suffix;
+    }
+};
+
+inline const json_error_body& bad_request_body() {
+    static json_error_body body{sl::pion::http_request::RESPONSE_CODE_BAD_REQUEST,
+            sl::pion::http_request::RESPONSE_MESSAGE_BAD_REQUEST};
+    return body;
+}
+
+inline const json_error_body& not_found_body() {
+    static json_error_body body{sl::pion::http_request::RESPONSE_CODE_NOT_FOUND,
+            sl::pion::http_request::RESPONSE_MESSAGE_NOT_FOUND};
+    return body;
+}
+
+/**
+ * Checks whether content coding is acceptable according
+ * to 'Accept-Encoding' header, codings with 'q=0' are rejected
+ *
+ * @param header 'Accept-Encoding' header value
+ * @param coding content coding name
+ * @return true if coding is acceptable
+ */
+inline bool accepts_encoding(const std::string& header, const std::string& coding) {
+    bool wildcard = false;
+    size_t pos = 0;
+    while (pos < header.length()) {
+        auto comma = header.find(',', pos);
+        if (std::string::npos == comma) {
+            comma = header.length();
+        }
+        auto item = header.substr(pos, comma - pos);
+        pos = comma + 1;
+        auto semicolon = item.find(';');
+        auto name = item.substr(0, semicolon);
+        auto first = name.find_first_not_of(" \t");
+        if (std::string::npos == first) {
+            continue;
+        }
+        name = name.substr(first, name.find_last_not_of(" \t") - first + 1);
+        for (auto& ch : name) {
+            if (ch >= 'A' && ch <= 'Z') ch = static_cast<char>(ch - 'A' + 'a');
+        }
+        double q = 1;
+        if (std::string::npos != semicolon) {
+            auto qpos = item.find("q=", semicolon);
+            if (std::string::npos != qpos) {
+                q = std::strtod(item.c_str() + qpos + 2, nullptr);
+            }
+        }
+        if (name == coding || ("gzip" == coding && "x-gzip" == name)) {
+            return q > 0;
+        }
+        if ("*" == name) {
+            wildcard = q > 0;
         }
     }
-    resp.change_header("Content-Type", ct);
+    return wildcard;
+}
+
+inline void set_response_headers(const document_root_headers& headers,
+        const std::string& url_path, sl::pion::http_response& resp) {
+    resp.change_header("Content-Type", headers.content_type(url_path));
     // set caching
-    resp.change_header("Cache-Control", "max-age=" + sl::support::to_string(conf.cacheMaxAgeSeconds) + ", public");
+    resp.change_header("Cache-Control", headers.cache_control_value());
 }
 
 void send400(sl::pion::response_writer_ptr resp, const std::string& url_path) {
-    auto msg = sl::json::dumps({
-        {"error", {
-            { "code", sl::pion::http_request::RESPONSE_CODE_BAD_REQUEST },
-            { "message", sl::pion::http_request::RESPONSE_MESSAGE_BAD_REQUEST },
-            { "path", url_path }}}
-    });
     resp->get_response().set_status_code(sl::pion::http_request::RESPONSE_CODE_NOT_FOUND);
     resp->get_response().set_status_message(sl::pion::http_request::RESPONSE_MESSAGE_NOT_FOUND);
-    resp->write(msg);
+    resp->write(bad_request_body().render(url_path));
     resp->send(std::move(resp));
 }
 
 void send404(sl::pion::response_writer_ptr resp, const std::string& url_path) {
-    auto msg = sl::json::dumps({
-        {"error", {
-            { "code", sl::pion::http_request::RESPONSE_CODE_NOT_FOUND },
-            { "message", sl::pion::http_request::RESPONSE_MESSAGE_NOT_FOUND },
-            { "path", url_path }}}
-    });
     resp->get_response().set_status_code(sl::pion::http_request::RESPONSE_CODE_NOT_FOUND);
     resp->get_response().set_status_message(sl::pion::http_request::RESPONSE_MESSAGE_NOT_FOUND);
-    resp->write(msg);
+    resp->write(not_found_body().render(url_path));
     resp->send(std::move(resp));
 }
 
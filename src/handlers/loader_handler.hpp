@@ -35,7 +35,12 @@
 #include "wilton/support/exception.hpp"
 
 #include "conf/document_root.hpp"
+#include "handlers/asset_cache.hpp"
 #include "handlers/handlers_common.hpp"
+#include "handlers/resource_cache.hpp"
+#include "http_conditional.hpp"
+#include "response_file_sender.hpp"
+#include "response_memory_sender.hpp"
 
 namespace wilton {
 namespace server {
@@ -43,19 +48,33 @@ namespace handlers {
 
 class loader_handler {
     std::shared_ptr<server::conf::document_root> conf;
+    std::shared_ptr<document_root_headers> headers;
+    std::shared_ptr<resource_cache> resources;
+    std::shared_ptr<asset_cache> assets;
 
 public:
     // must be copyable to satisfy std::function
     loader_handler(const loader_handler& other) :
-    conf(other.conf) { }
+    conf(other.conf),
+    headers(other.headers),
+    resources(other.resources),
+    assets(other.assets) { }
 
     loader_handler& operator=(const loader_handler& other) {
         this->conf = other.conf;
+        this->headers = other.headers;
+        this->resources = other.resources;
+        this->assets = other.assets;
         return *this;
     }
 
-    loader_handler(const server::conf::document_root& conf) :
-    conf(std::make_shared<server::conf::document_root>(conf.clone())) { }
+    loader_handler(const server::conf::document_root& conf,
+            std::shared_ptr<resource_cache> resources = std::shared_ptr<resource_cache>(),
+            std::shared_ptr<asset_cache> assets = std::shared_ptr<asset_cache>()) :
+    conf(std::make_shared<server::conf::document_root>(conf.clone())),
+    headers(std::make_shared<document_root_headers>(conf)),
+    resources(std::move(resources)),
+    assets(std::move(assets)) { }
 
     void operator()(sl::pion::http_request_ptr req, sl::pion::response_writer_ptr resp) {
         if (req->get_resource().length() < conf->resource.length()) {
@@ -71,23 +90,85 @@ public:
             path = path.substr(1);
         }
         auto url_path = conf->resourceLoaderPrefix + path;
+        auto res = nullptr != resources.get() ? find_cached(url_path) : find_asset(url_path);
+        if (nullptr == res.get()) {
+            send404(std::move(resp), url_path);
+            return;
+        }
+
+        auto& rp = resp->get_response();
+        set_response_headers(*headers, url_path, rp);
+        // only resources kept in the resource cache have an ETag
+        if (!res->etag.empty()) {
+            set_validator_headers(rp, res->etag, "");
+            if (is_not_modified(*req, res->etag, -1)) {
+                send304(std::move(resp));
+                return;
+            }
+        }
+        if ("HEAD" == req->get_method()) {
+            send_head(std::move(resp), static_cast<uint64_t>(res->length));
+            return;
+        }
+        const char* data = res->data.get();
+        size_t length = res->length;
+        auto sender = sl::support::make_unique<response_memory_sender>(std::move(resp), std::move(res),
+                data, length);
+        sender->send(std::move(sender));
+    }
 
+private:
+    std::shared_ptr<const loaded_resource> find_cached(const std::string& url_path) {
+        auto res = resources->get(url_path);
+        if (nullptr != res.get()) {
+            return res;
+        }
+        res = load(url_path);
+        if (nullptr == res.get() || !resources->admits(res->length)) {
+            return res;
+        }
+        // content is hashed once, when the resource is cached
+        auto etag = make_content_etag(res->data.get(), res->length);
+        auto cached = std::make_shared<const loaded_resource>(res->data, res->length, std::move(etag));
+        resources->put(url_path, cached);
+        return cached;
+    }
+
+    // used when the resource cache is disabled, loaded resources
+    // do not change while the application is running
+    std::shared_ptr<const loaded_resource> find_asset(const std::string& url_path) {
+        if (nullptr == assets.get()) {
+            return load(url_path);
+        }
+        auto key = "loader:" + url_path;
+        auto body = assets->get(key, "");
+        if (nullptr == body.get()) {
+            auto res = load(url_path);
+            if (nullptr == res.get() || !assets->admits(static_cast<uint64_t>(res->length))) {
+                return res;
+            }
+            body = std::make_shared<const std::string>(res->data.get(), res->length);
+            assets->put(key, "", body);
+        }
+        // points into the cached body and keeps it alive
+        auto data = std::shared_ptr<const char>(body, body->data());
+        return std::make_shared<const loaded_resource>(std::move(data), body->length(), "");
+    }
+
+    static std::shared_ptr<const loaded_resource> load(const std::string& url_path) {
         char* loaded = nullptr;
         int loaded_len = 0;
         auto err = wilton_load_resource(url_path.c_str(), static_cast<int>(url_path.length()),
                 std::addressof(loaded), std::addressof(loaded_len));
         if (nullptr != err) {
             wilton_free(err);
-            send404(std::move(resp), url_path);
-            return;
+            return std::shared_ptr<const loaded_resource>();
         }
-        auto deferred = sl::support::defer([loaded] () STATICLIB_NOEXCEPT {
-            wilton_free(loaded);
+        // loader buffer is owned by the resource and is not copied
+        auto data = std::shared_ptr<const char>(loaded, [](const char* ptr) {
+            wilton_free(const_cast<char*>(ptr));
         });
-
-        set_response_headers(*conf, url_path, resp->get_response());
-        resp->write({loaded, loaded_len});
-        resp->send(std::move(resp));
+        return std::make_shared<const loaded_resource>(std::move(data), static_cast<size_t>(loaded_len), "");
     }
 
 };
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   resource_cache.hpp
+ * Author: alex
+ *
+ * Created on October 21, 2026, 10:20 AM
+ */
+
+#ifndef WILTON_SERVER_HANDLERS_RESOURCE_CACHE_HPP
+#define WILTON_SERVER_HANDLERS_RESOURCE_CACHE_HPP
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace wilton {
+namespace server {
+namespace handlers {
+
+/**
+ * Resource obtained from 'wilton_load_resource', buffer returned
+ * by the loader is kept as is and is sent without copying
+ */
+class loaded_resource {
+public:
+    std::shared_ptr<const char> data;
+    size_t length;
+    std::string etag;
+
+    loaded_resource(std::shared_ptr<const char> data, size_t length, std::string etag) :
+    data(std::move(data)),
+    length(length),
+    etag(std::move(etag)) { }
+};
+
+/**
+ * Server-wide memory-budgeted LRU cache of loaded resources keyed
+ * by 'resourceLoaderPrefix' + path; resources do not change on their
+ * own while the application is running, so entries are only dropped
+ * on eviction or on explicit invalidation
+ */
+class resource_cache {
+    class entry {
+    public:
+        std::shared_ptr<const loaded_resource> resource;
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    uint64_t max_bytes;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, entry> entries;
+    // most recently used first
+    std::list<std::string> lru;
+    uint64_t bytes = 0;
+
+public:
+    resource_cache(uint64_t max_bytes) :
+    max_bytes(max_bytes) { }
+
+    resource_cache(const resource_cache&) = delete;
+
+    resource_cache& operator=(const resource_cache&) = delete;
+
+    /**
+     * Checks whether resource of the specified size can be cached
+     *
+     * @param size resource size
+     * @return true if resource fits into byte budget
+     */
+    bool admits(uint64_t size) const {
+        return size <= max_bytes;
+    }
+
+    /**
+     * Looks up cached resource
+     *
+     * @param key resource path with loader prefix
+     * @return cached resource or null
+     */
+    std::shared_ptr<const loaded_resource> get(const std::string& key) {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = entries.find(key);
+        if (entries.end() == it) {
+            return std::shared_ptr<const loaded_resource>();
+        }
+        lru.splice(lru.begin(), lru, it->second.lru_pos);
+        return it->second.resource;
+    }
+
+    /**
+     * Adds resource to cache evicting least recently used
+     * entries to fit into byte budget
+     *
+     * @param key resource path with loader prefix
+     * @param resource loaded resource
+     */
+    void put(const std::string& key, std::shared_ptr<const loaded_resource> resource) {
+        if (!admits(resource->length)) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard{mutex};
+        auto existing = entries.find(key);
+        if (entries.end() != existing) {
+            erase_entry(existing);
+        }
+        while (bytes + resource->length > max_bytes && !lru.empty()) {
+            erase_entry(entries.find(lru.back()));
+        }
+        bytes += resource->length;
+        lru.push_front(key);
+        auto en = entry();
+        en.resource = std::move(resource);
+        en.lru_pos = lru.begin();
+        entries.emplace(key, std::move(en));
+    }
+
+    /**
+     * Drops cached resources
+     *
+     * @param prefix key prefix, empty prefix drops all entries
+     */
+    void invalidate(const std::string& prefix) {
+        std::lock_guard<std::mutex> guard{mutex};
+        for (auto it = entries.begin(); it != entries.end();) {
+            auto cur = it++;
+            if (0 == cur->first.compare(0, prefix.length(), prefix)) {
+                erase_entry(cur);
+            }
+        }
+    }
+
+private:
+    // must be called under lock
+    void erase_entry(std::unordered_map<std::string, entry>::iterator it) {
+        bytes -= it->second.resource->length;
+        lru.erase(it->second.lru_pos);
+        entries.erase(it);
+    }
+
+};
+
+} // namespace
+}
+}
+
+#endif /* WILTON_SERVER_HANDLERS_RESOURCE_CACHE_HPP */
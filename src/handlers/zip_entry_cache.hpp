@@ -0,0 +1,182 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   zip_entry_cache.hpp
+ * Author: alex
+ *
+ * Created on October 19, 2026, 2:30 PM
+ */
+
+#ifndef WILTON_SERVER_HANDLERS_ZIP_ENTRY_CACHE_HPP
+#define WILTON_SERVER_HANDLERS_ZIP_ENTRY_CACHE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace wilton {
+namespace server {
+namespace handlers {
+
+/**
+ * Memory-budgeted LRU cache of inflated zip entries, entries larger
+ * than the budget are not admitted; entry is inflated once, concurrent
+ * misses on the entry that is being inflated register waiters that are
+ * called when the inflation completes, so no thread blocks on it
+ */
+class zip_entry_cache {
+public:
+    using value_type = std::shared_ptr<const std::string>;
+    // called with entry contents, or with null if entry was not inflated
+    using waiter_type = std::function<void(value_type)>;
+
+private:
+    class entry {
+    public:
+        // null while inflation is in progress
+        value_type value;
+        std::vector<waiter_type> waiters;
+        uint64_t size = 0;
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    uint64_t max_bytes;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, entry> entries;
+    // most recently used first, only ready entries
+    std::list<std::string> lru;
+    uint64_t bytes = 0;
+
+public:
+    zip_entry_cache(uint64_t max_bytes) :
+    max_bytes(max_bytes) { }
+
+    zip_entry_cache(const zip_entry_cache&) = delete;
+
+    zip_entry_cache& operator=(const zip_entry_cache&) = delete;
+
+    /**
+     * Checks whether entry of the specified size can be cached,
+     * must be called before inflating the entry
+     *
+     * @param size uncompressed entry size
+     * @return false if entry is larger than the cache budget
+     */
+    bool admits(uint64_t size) const {
+        return size <= max_bytes;
+    }
+
+    /**
+     * Returns cached entry contents
+     *
+     * @param key entry inner path
+     * @return entry contents, null if entry is not cached or is being inflated
+     */
+    value_type get(const std::string& key) {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = entries.find(key);
+        if (entries.end() == it || nullptr == it->second.value.get()) {
+            return value_type();
+        }
+        lru.splice(lru.begin(), lru, it->second.lru_pos);
+        return it->second.value;
+    }
+
+    /**
+     * Registers waiter for the entry contents, waiter is called
+     * immediately if the entry is cached, or when the inflation
+     * in progress completes
+     *
+     * @param key entry inner path
+     * @param waiter callback for the entry contents
+     * @return true if the caller must inflate the entry and call 'complete'
+     */
+    bool wait_or_load(const std::string& key, waiter_type waiter) {
+        auto ready = value_type();
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            auto it = entries.find(key);
+            if (entries.end() == it) {
+                auto en = entry();
+                en.waiters.emplace_back(std::move(waiter));
+                entries.emplace(key, std::move(en));
+                return true;
+            }
+            auto& en = it->second;
+            if (nullptr == en.value.get()) {
+                en.waiters.emplace_back(std::move(waiter));
+                return false;
+            }
+            lru.splice(lru.begin(), lru, en.lru_pos);
+            ready = en.value;
+        }
+        waiter(std::move(ready));
+        return false;
+    }
+
+    /**
+     * Stores inflated entry and calls its waiters
+     *
+     * @param key entry inner path
+     * @param value entry contents, null if inflation failed
+     */
+    void complete(const std::string& key, value_type value) {
+        auto waiters = std::vector<waiter_type>();
+        {
+            std::lock_guard<std::mutex> guard{mutex};
+            auto it = entries.find(key);
+            if (entries.end() == it) {
+                return;
+            }
+            waiters.swap(it->second.waiters);
+            if (nullptr == value.get() || value->length() > max_bytes) {
+                entries.erase(it);
+            } else {
+                auto& en = it->second;
+                en.value = value;
+                en.size = value->length();
+                lru.push_front(key);
+                en.lru_pos = lru.begin();
+                bytes += en.size;
+                while (bytes > max_bytes) {
+                    auto last = entries.find(lru.back());
+                    bytes -= last->second.size;
+                    lru.pop_back();
+                    entries.erase(last);
+                }
+            }
+        }
+        // called without the lock, waiters may access the cache
+        for (auto& wa : waiters) {
+            wa(value);
+        }
+    }
+
+};
+
+} // namespace
+}
+}
+
+#endif /* WILTON_SERVER_HANDLERS_ZIP_ENTRY_CACHE_HPP */
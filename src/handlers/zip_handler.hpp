@@ -25,8 +25,14 @@
 #define WILTON_SERVER_HANDLERS_ZIP_HANDLER_HPP
 
 #include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <array>
+#include <istream>
+#include <iterator>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "staticlib/config.hpp"
 #include "staticlib/io.hpp"
@@ -34,33 +40,169 @@
 
 #include "wilton/support/exception.hpp"
 
+#include "blocking_io_pool.hpp"
 #include "conf/document_root.hpp"
+#include "handlers/asset_cache.hpp"
 #include "handlers/handlers_common.hpp"
+#include "handlers/zip_entry_cache.hpp"
+#include "handlers/zip_index.hpp"
+#include "http_conditional.hpp"
+#include "http_range.hpp"
+#include "inflate_source.hpp"
+#include "native_file.hpp"
+#include "response_file_sender.hpp"
+#include "response_memory_sender.hpp"
 #include "response_stream_sender.hpp"
 
 namespace wilton {
 namespace server {
 namespace handlers {
 
+namespace { // anonymous
+
+const uint16_t zip_method_stored = 0;
+
+const uint16_t zip_method_deflated = 8;
+
+const size_t zip_local_header_size = 30;
+
+class zip_local_header {
+public:
+    // zero if local header cannot be read
+    uint64_t data_offset = 0;
+};
+
+/**
+ * Reads entry local header from the archive, checksum is taken
+ * from the central directory as the local header does not have it
+ * when data descriptor is used
+ *
+ * @param archive opened archive
+ * @param en entry from the central directory
+ * @return data offset of the entry
+ */
+zip_local_header read_local_header(native_file& archive, const zip_index_entry& en) {
+    auto res = zip_local_header();
+    auto buf = std::array<char, zip_local_header_size>();
+    uint64_t header_offset = static_cast<uint64_t>(en.offset);
+    auto read = archive.read_at({buf.data(), buf.size()}, header_offset);
+    if (static_cast<std::streamsize>(buf.size()) != read ||
+            !('P' == buf[0] && 'K' == buf[1] && 3 == buf[2] && 4 == buf[3])) {
+        return res;
+    }
+    auto le16 = [&buf](size_t pos) -> uint32_t {
+        return static_cast<uint32_t>(static_cast<uint8_t>(buf[pos])) |
+                (static_cast<uint32_t>(static_cast<uint8_t>(buf[pos + 1])) << 8);
+    };
+    res.data_offset = header_offset + zip_local_header_size + le16(26) + le16(28);
+    return res;
+}
+
+// RFC 1952 member header without name and mtime, OS is unknown
+const std::string gzip_header = std::string("\x1f\x8b\x08\x00\x00\x00\x00\x00\x00\xff", 10);
+
+const size_t gzip_trailer_size = 8;
+
+std::string gzip_trailer(uint32_t crc32, uint64_t size) {
+    auto res = std::string();
+    uint32_t isize = static_cast<uint32_t>(size & 0xffffffff);
+    for (size_t i = 0; i < 4; i++) {
+        res.push_back(static_cast<char>((crc32 >> (i * 8)) & 0xff));
+    }
+    for (size_t i = 0; i < 4; i++) {
+        res.push_back(static_cast<char>((isize >> (i * 8)) & 0xff));
+    }
+    return res;
+}
+
+/**
+ * Reader of the raw DEFLATE entry data wrapped into a gzip member
+ *
+ * @param archive opened archive
+ * @param data_offset entry data offset within the archive
+ * @param comp_length compressed entry size
+ * @param trailer gzip trailer with CRC32 and uncompressed size
+ * @return positional reader
+ */
+positional_reader make_gzip_reader(std::shared_ptr<native_file> archive, uint64_t data_offset,
+        uint64_t comp_length, std::string trailer) {
+    return [archive, data_offset, comp_length, trailer](sl::io::span<char> span,
+            uint64_t pos) -> std::streamsize {
+        uint64_t header_len = gzip_header.length();
+        const std::string* str = nullptr;
+        uint64_t str_pos = 0;
+        if (pos < header_len) {
+            str = std::addressof(gzip_header);
+            str_pos = pos;
+        } else if (pos < header_len + comp_length) {
+            uint64_t avail = header_len + comp_length - pos;
+            size_t len = static_cast<size_t>(std::min(avail, static_cast<uint64_t>(span.size())));
+            return archive->read_at({span.data(), len}, data_offset + pos - header_len);
+        } else {
+            str = std::addressof(trailer);
+            str_pos = pos - header_len - comp_length;
+        }
+        uint64_t avail = str->length() - str_pos;
+        size_t len = static_cast<size_t>(std::min(avail, static_cast<uint64_t>(span.size())));
+        std::memcpy(span.data(), str->data() + str_pos, len);
+        return static_cast<std::streamsize>(len);
+    };
+}
+
+// response writer that waits for the entry inflation
+class pending_response {
+public:
+    sl::pion::response_writer_ptr writer;
+};
+
+} // namespace
+
 class zip_handler {
     std::shared_ptr<server::conf::document_root> conf;
-    std::shared_ptr<sl::unzip::file_index> idx;
+    std::shared_ptr<document_root_headers> headers;
+    // entries are read positionally, so truncated or rewritten
+    // archive results in read errors rather than in faults
+    std::shared_ptr<native_file> archive;
+    std::shared_ptr<zip_index> idx;
+    std::shared_ptr<asset_cache> assets;
+    std::shared_ptr<blocking_io_pool> io_pool;
+    std::shared_ptr<zip_entry_cache> inflated;
 
 public:
     // must be copyable to satisfy std::function
     zip_handler(const zip_handler& other) :
     conf(other.conf),
-    idx(other.idx) { }
+    headers(other.headers),
+    archive(other.archive),
+    idx(other.idx),
+    assets(other.assets),
+    io_pool(other.io_pool),
+    inflated(other.inflated) { }
 
     zip_handler& operator=(const zip_handler& other) {
         this->conf = other.conf;
+        this->headers = other.headers;
         this->idx = other.idx;
+        this->archive = other.archive;
+        this->assets = other.assets;
+        this->io_pool = other.io_pool;
+        this->inflated = other.inflated;
         return *this;
     }
 
-    zip_handler(const server::conf::document_root& conf) :
+    zip_handler(const server::conf::document_root& conf,
+            std::shared_ptr<asset_cache> assets = std::shared_ptr<asset_cache>(),
+            std::shared_ptr<blocking_io_pool> io_pool = std::shared_ptr<blocking_io_pool>()) :
     conf(std::make_shared<server::conf::document_root>(conf.clone())),
-    idx(std::make_shared<sl::unzip::file_index>(conf.zipPath)) { }
+    headers(std::make_shared<document_root_headers>(conf)),
+    archive(native_file::open(conf.zipPath)),
+    idx(std::make_shared<zip_index>(conf.zipPath, archive, conf.zipIndexPath)),
+    assets(std::move(assets)),
+    io_pool(std::move(io_pool)) {
+        if (this->conf->zipEntryCacheMaxBytes > 0) {
+            this->inflated = std::make_shared<zip_entry_cache>(this->conf->zipEntryCacheMaxBytes);
+        }
+    }
 
     void operator()(sl::pion::http_request_ptr req, sl::pion::response_writer_ptr resp) {
         if (req->get_resource().length() < conf->resource.length()) {
@@ -76,17 +218,329 @@ public:
             path = path.substr(1);
         }
         std::string url_path = conf->zipInnerPrefix + path;
-        sl::unzip::file_entry en = idx->find_zip_entry(url_path);
+        zip_index_entry en = idx->find(url_path);
         if (en.is_empty()) {
             send404(std::move(resp), url_path);
             return;
         }
-        auto stream_ptr = sl::unzip::open_zip_entry(*idx, url_path);
-        set_response_headers(*conf, url_path, resp->get_response());
-        auto sender = sl::support::make_unique<response_stream_sender>(std::move(resp), std::move(stream_ptr));
+        auto& rp = resp->get_response();
+        set_response_headers(*headers, url_path, rp);
+        rp.change_header("Accept-Ranges", "bytes");
+        uint64_t size = static_cast<uint64_t>(en.uncomp_length);
+        auto header = zip_local_header();
+        auto etag = std::string();
+        auto last_modified = std::string();
+        int64_t mtime = -1;
+        if (nullptr != archive.get()) {
+            header = read_local_header(*archive, en);
+            if (en.has_crc32) {
+                etag = make_zip_etag(en.crc32, size);
+            } else {
+                // archive is not modified while the server is running
+                etag = make_file_etag(archive->inode(), static_cast<uint64_t>(en.offset), archive->mtime());
+            }
+            mtime = archive->mtime();
+            last_modified = format_http_date(mtime);
+        }
+        bool gzip = is_gzip_passthrough(*req, en, header);
+        if (conf->zipDeflatePassthrough) {
+            rp.change_header("Vary", "Accept-Encoding");
+        }
+        if (gzip) {
+            rp.change_header("Content-Encoding", "gzip");
+            // encoded representation must have its own tag
+            etag.insert(etag.length() - 1, "-gzip");
+        }
+        set_validator_headers(rp, etag, last_modified);
+        if (is_not_modified(*req, etag, mtime)) {
+            send304(std::move(resp));
+            return;
+        }
+        if ("HEAD" == req->get_method()) {
+            send_head(std::move(resp), gzip ? gzip_length(en) : size);
+            return;
+        }
+        if (gzip) {
+            send_gzip(std::move(resp), en, header);
+            return;
+        }
+        auto ranges = std::vector<byte_range>();
+        auto status = read_request_ranges(*req, size, etag, last_modified, ranges);
+        if (range_status::unsatisfiable == status) {
+            send416(std::move(resp), size);
+            return;
+        }
+        if (range_status::satisfiable == status) {
+            send_ranges(*req, std::move(resp), url_path, en, header.data_offset, etag, last_modified,
+                    std::move(ranges));
+            return;
+        }
+        if (zip_method_stored == en.comp_method && is_readable(header.data_offset, size)) {
+            // 'sendfile' or, over TLS, reads on the blocking IO pool
+            send_native_file(*req, std::move(resp), archive, header.data_offset, size, etag, last_modified,
+                    [](bool){}, io_pool);
+            return;
+        }
+        uint64_t data_offset = header.data_offset;
+        if (is_inflated_cached(en)) {
+            auto body = inflated->get(url_path);
+            if (nullptr != body.get()) {
+                send_body(std::move(resp), std::move(body));
+                return;
+            }
+            auto handler = *this;
+            with_inflated(url_path, en, data_offset, on_io_thread(std::move(resp),
+                    [handler, url_path, en, data_offset](sl::pion::response_writer_ptr resp,
+                            std::shared_ptr<const std::string> body) mutable {
+                handler.send_body_or_stream(std::move(resp), std::move(body), url_path, en, data_offset);
+            }));
+            return;
+        }
+        if (nullptr != assets.get() && assets->admits(size)) {
+            auto key = conf->zipPath + "/" + url_path;
+            auto body = assets->get(key, etag);
+            if (nullptr != body.get()) {
+                send_body(std::move(resp), std::move(body));
+                return;
+            }
+            auto handler = *this;
+            auto cache = assets;
+            auto send = on_io_thread(std::move(resp),
+                    [handler, url_path, en, data_offset](sl::pion::response_writer_ptr resp,
+                            std::shared_ptr<const std::string> body) mutable {
+                handler.send_body_or_stream(std::move(resp), std::move(body), url_path, en, data_offset);
+            });
+            inflate_async(url_path, en, data_offset, [cache, key, etag, send](std::shared_ptr<const std::string> body) {
+                if (nullptr != body.get()) {
+                    cache->put(key, etag, body);
+                }
+                send(std::move(body));
+            });
+            return;
+        }
+        send_stream(std::move(resp), url_path, en, data_offset);
+    }
+
+private:
+    void send_ranges(const sl::pion::http_request& req, sl::pion::response_writer_ptr resp,
+            const std::string& url_path, const zip_index_entry& en, uint64_t data_offset,
+            const std::string& etag, const std::string& last_modified, std::vector<byte_range> ranges) {
+        uint64_t size = static_cast<uint64_t>(en.uncomp_length);
+        // stored entries are read directly from the archive
+        if (zip_method_stored == en.comp_method && nullptr != archive.get() && data_offset > 0) {
+            send_native_file(req, std::move(resp), archive, data_offset, size, etag, last_modified,
+                    [](bool){}, io_pool);
+            return;
+        }
+        if (is_inflated_cached(en)) {
+            auto body = inflated->get(url_path);
+            if (nullptr != body.get()) {
+                send_ranges_body(std::move(resp), std::move(body), url_path, en, data_offset, std::move(ranges));
+                return;
+            }
+            auto handler = *this;
+            with_inflated(url_path, en, data_offset, on_io_thread(std::move(resp),
+                    [handler, url_path, en, data_offset, ranges](sl::pion::response_writer_ptr resp,
+                            std::shared_ptr<const std::string> body) mutable {
+                handler.send_ranges_body(std::move(resp), std::move(body), url_path, en, data_offset,
+                        std::move(ranges));
+            }));
+            return;
+        }
+        send_ranges_body(std::move(resp), std::shared_ptr<const std::string>(), url_path, en, data_offset,
+                std::move(ranges));
+    }
+
+    // body is null if entry is not inflated
+    void send_ranges_body(sl::pion::response_writer_ptr resp, std::shared_ptr<const std::string> body,
+            const std::string& url_path, const zip_index_entry& en, uint64_t data_offset,
+            std::vector<byte_range> ranges) {
+        uint64_t size = static_cast<uint64_t>(en.uncomp_length);
+        auto& rp = resp->get_response();
+        auto ct = std::string(rp.get_header("Content-Type"));
+        auto boundary = set_partial_headers(rp, ranges, size);
+        auto reader = positional_reader();
+        if (nullptr != body.get()) {
+            reader = [body](sl::io::span<char> span, uint64_t pos) -> std::streamsize {
+                auto len = std::min(static_cast<uint64_t>(span.size()), body->length() - pos);
+                std::memcpy(span.data(), body->data() + pos, static_cast<size_t>(len));
+                return static_cast<std::streamsize>(len);
+            };
+        } else {
+            // compressed entries are inflated sequentially skipping the bytes before each range
+            reader = make_sequential_reader(open_entry(url_path, en, data_offset));
+        }
+        auto src = byte_ranges_source(std::move(reader), std::move(ranges), boundary, ct, size);
+        auto body_length = src.total_length();
+        auto src_ptr = sl::io::make_source_istream_ptr(std::move(src));
+        auto sender = sl::support::make_unique<response_stream_sender>(std::move(resp), std::move(src_ptr), body_length,
+                [](bool){}, io_pool);
+        sender->send(std::move(sender));
+    }
+
+    // only applies to full responses, 'Range' requests are served inflated
+    bool is_gzip_passthrough(const sl::pion::http_request& req, const zip_index_entry& en,
+            const zip_local_header& header) {
+        return conf->zipDeflatePassthrough &&
+                zip_method_deflated == en.comp_method &&
+                nullptr != archive.get() &&
+                header.data_offset > 0 &&
+                en.has_crc32 &&
+                req.get_header("Range").empty() &&
+                accepts_encoding(req.get_header("Accept-Encoding"), "gzip");
+    }
+
+    static uint64_t gzip_length(const zip_index_entry& en) {
+        return gzip_header.length() + static_cast<uint64_t>(en.comp_length) + gzip_trailer_size;
+    }
+
+    void send_gzip(sl::pion::response_writer_ptr resp, const zip_index_entry& en,
+            const zip_local_header& header) {
+        uint64_t length = gzip_length(en);
+        auto trailer = gzip_trailer(en.crc32, static_cast<uint64_t>(en.uncomp_length));
+        auto reader = make_gzip_reader(archive, header.data_offset, static_cast<uint64_t>(en.comp_length),
+                std::move(trailer));
+        auto ranges = std::vector<byte_range>();
+        ranges.emplace_back(0, length - 1);
+        auto src = byte_ranges_source(std::move(reader), std::move(ranges), "", "", length);
+        auto src_ptr = sl::io::make_source_istream_ptr(std::move(src));
+        auto sender = sl::support::make_unique<response_stream_sender>(std::move(resp), std::move(src_ptr), length,
+                [](bool){}, io_pool);
+        sender->send(std::move(sender));
+    }
+
+    bool is_readable(uint64_t data_offset, uint64_t length) {
+        return nullptr != archive.get() && archive->is_regular_file() && data_offset > 0 &&
+                data_offset <= archive->size() && length <= archive->size() - data_offset;
+    }
+
+    // deflated entries are inflated from positional reads of the archive when it is available
+    std::unique_ptr<std::istream> open_entry(const std::string& url_path,
+            const zip_index_entry& en, uint64_t data_offset) {
+#ifndef STATICLIB_WINDOWS
+        uint64_t comp_length = static_cast<uint64_t>(en.comp_length);
+        if (zip_method_deflated == en.comp_method && is_readable(data_offset, comp_length)) {
+            auto src = inflate_source(archive, data_offset, comp_length);
+            return sl::io::make_source_istream_ptr(std::move(src));
+        }
+#endif // !STATICLIB_WINDOWS
+        return sl::unzip::open_zip_entry(idx->unzip_index(), url_path);
+    }
+
+    // entries over the cache budget are streamed without being inflated whole
+    bool is_inflated_cached(const zip_index_entry& en) {
+        return nullptr != inflated.get() && zip_method_stored != en.comp_method &&
+                inflated->admits(static_cast<uint64_t>(en.uncomp_length));
+    }
+
+    void send_body(sl::pion::response_writer_ptr resp, std::shared_ptr<const std::string> body) {
+        auto sender = sl::support::make_unique<response_memory_sender>(std::move(resp), std::move(body));
+        sender->send(std::move(sender));
+    }
+
+    void send_stream(sl::pion::response_writer_ptr resp, const std::string& url_path,
+            const zip_index_entry& en, uint64_t data_offset) {
+        uint64_t size = static_cast<uint64_t>(en.uncomp_length);
+        auto stream_ptr = open_entry(url_path, en, data_offset);
+        auto sender = sl::support::make_unique<response_stream_sender>(std::move(resp), std::move(stream_ptr), size,
+                [](bool){}, io_pool);
         sender->send(std::move(sender));
     }
 
+    // entry that was not inflated is streamed, errors are reported from there
+    void send_body_or_stream(sl::pion::response_writer_ptr resp, std::shared_ptr<const std::string> body,
+            const std::string& url_path, const zip_index_entry& en, uint64_t data_offset) {
+        if (nullptr != body.get()) {
+            send_body(std::move(resp), std::move(body));
+        } else {
+            send_stream(std::move(resp), url_path, en, data_offset);
+        }
+    }
+
+    /**
+     * Wraps response sending into a callback that may be called on any thread,
+     * 'send' is called with the response on its IO thread
+     *
+     * @param resp response writer
+     * @param send function that sends the response with the inflated entry
+     * @return callback for the inflated entry
+     */
+    template<typename Send>
+    static zip_entry_cache::waiter_type on_io_thread(sl::pion::response_writer_ptr resp, Send send) {
+        auto ios = std::addressof(resp->get_connection()->get_io_service());
+        auto holder = sl::support::make_unique<pending_response>();
+        holder->writer = std::move(resp);
+        auto holder_shared = sl::support::make_shared_with_release_deleter(holder.release());
+        return [ios, holder_shared, send](std::shared_ptr<const std::string> body) {
+            ios->post([holder_shared, send, body]() mutable {
+                auto holder = sl::support::make_unique_from_shared_with_release_deleter(holder_shared);
+                if (nullptr != holder.get()) {
+                    send(std::move(holder->writer), std::move(body));
+                }
+            });
+        };
+    }
+
+    // concurrent requests for the same entry wait for a single inflation
+    void with_inflated(const std::string& url_path, const zip_index_entry& en, uint64_t data_offset,
+            zip_entry_cache::waiter_type waiter) {
+        if (!inflated->wait_or_load(url_path, std::move(waiter))) {
+            return;
+        }
+        auto cache = inflated;
+        inflate_async(url_path, en, data_offset, [cache, url_path](std::shared_ptr<const std::string> body) {
+            cache->complete(url_path, std::move(body));
+        });
+    }
+
+    /**
+     * Inflates the entry on the blocking IO pool, inline when the pool
+     * has no threads
+     *
+     * @param url_path entry inner path
+     * @param en entry from the central directory
+     * @param data_offset entry data offset within the archive
+     * @param done called with the entry, or with null if it cannot be
+     *        inflated or the pool is stopped
+     */
+    template<typename Done>
+    void inflate_async(const std::string& url_path, const zip_index_entry& en, uint64_t data_offset,
+            Done done) {
+        auto handler = *this;
+        auto load = [handler, url_path, en, data_offset, done]() mutable {
+            auto body = std::shared_ptr<const std::string>();
+            try {
+                body = handler.inflate_entry(url_path, en, data_offset);
+            } catch (const std::exception&) {
+                // entry is streamed and the error is reported from there
+            }
+            done(std::move(body));
+        };
+        auto pool = io_pool.get();
+        if (nullptr == pool) {
+            load();
+        } else if (!pool->has_workers()) {
+            pool->run_inline(load);
+        } else {
+            pool->submit(load, [done]() mutable {
+                done(std::shared_ptr<const std::string>());
+            });
+        }
+    }
+
+    std::shared_ptr<const std::string> inflate_entry(const std::string& url_path,
+            const zip_index_entry& en, uint64_t data_offset) {
+        uint64_t size = static_cast<uint64_t>(en.uncomp_length);
+        auto stream_ptr = open_entry(url_path, en, data_offset);
+        auto res = std::make_shared<std::string>();
+        res->reserve(static_cast<size_t>(size));
+        res->assign(std::istreambuf_iterator<char>(*stream_ptr), std::istreambuf_iterator<char>());
+        if (res->length() != size) {
+            return std::shared_ptr<const std::string>();
+        }
+        return std::move(res);
+    }
+
 };
 
 } // namespace
@@ -0,0 +1,486 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   zip_index.hpp
+ * Author: alex
+ *
+ * Created on October 20, 2026, 3:10 PM
+ */
+
+#ifndef WILTON_SERVER_HANDLERS_ZIP_INDEX_HPP
+#define WILTON_SERVER_HANDLERS_ZIP_INDEX_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "staticlib/unzip.hpp"
+
+#include "wilton/support/exception.hpp"
+#include "wilton/support/logging.hpp"
+
+#include "mapped_file.hpp"
+#include "native_file.hpp"
+
+namespace wilton {
+namespace server {
+namespace handlers {
+
+/**
+ * Location of the entry data within the archive
+ */
+class zip_index_entry {
+public:
+    // local header offset
+    uint64_t offset = 0;
+    uint64_t comp_length = 0;
+    uint64_t uncomp_length = 0;
+    uint16_t comp_method = 0;
+    // from the central directory, local header may not have it
+    uint32_t crc32 = 0;
+    // not available with 'sl::unzip' index
+    bool has_crc32 = false;
+    bool present = false;
+
+    bool is_empty() const {
+        return !present;
+    }
+};
+
+namespace { // anonymous
+
+const char zip_index_magic[] = "WZIPIDX2";
+
+// detects index written on the host with other byte order
+const uint64_t zip_index_byte_order = 0x0102030405060708ULL;
+
+// magic, byte order, archive size, archive mtime, entries count, names offset
+const size_t zip_index_header_size = 48;
+
+// hash, name offset, name length, method, padding, offset, comp length, uncomp length, crc32, padding
+const size_t zip_index_record_size = 56;
+
+template<typename T>
+T zip_index_load(const char* ptr) {
+    T res;
+    std::memcpy(std::addressof(res), ptr, sizeof(T));
+    return res;
+}
+
+template<typename T>
+void zip_index_store(std::string& dest, T val) {
+    dest.append(reinterpret_cast<const char*>(std::addressof(val)), sizeof(T));
+}
+
+uint64_t zip_index_le(const char* ptr, size_t len) {
+    uint64_t res = 0;
+    for (size_t i = 0; i < len; i++) {
+        res |= static_cast<uint64_t>(static_cast<uint8_t>(ptr[i])) << (i * 8);
+    }
+    return res;
+}
+
+uint64_t zip_index_hash(const char* data, size_t len) {
+    // FNV-1a
+    uint64_t res = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++) {
+        res ^= static_cast<uint8_t>(data[i]);
+        res *= 1099511628211ULL;
+    }
+    return res;
+}
+
+} // namespace
+
+/**
+ * Lookup table over the central directory of the zip archive; table
+ * is a sorted by path hash array of fixed-size records followed by
+ * entry names, it is built in background from the central directory
+ * read with 'pread' (archive itself is not mapped) and optionally
+ * persisted to a sidecar file that is mapped on the next start while
+ * archive size and mtime stay the same; when positional reads are
+ * not available 'sl::unzip::file_index' is used instead
+ */
+class zip_index {
+    std::string zip_path;
+    std::shared_ptr<native_file> archive;
+    std::string sidecar_path;
+
+    // table contents, either mapped sidecar or in-memory string
+    std::shared_future<std::shared_ptr<const void>> table;
+    const char* table_data = nullptr;
+    uint64_t central_dir_offset = 0;
+    uint64_t central_dir_size = 0;
+    uint64_t entries_count = 0;
+    std::once_flag table_flag;
+    bool table_failed = false;
+
+    std::once_flag unzip_flag;
+    std::shared_ptr<sl::unzip::file_index> unzip_idx;
+
+public:
+    /**
+     * Reads the archive end of central directory record and starts
+     * building the table in background if it is not persisted
+     *
+     * @param zip_path archive path
+     * @param archive opened archive, may be null
+     * @param sidecar_path persisted table path, may be empty
+     */
+    zip_index(const std::string& zip_path, std::shared_ptr<native_file> archive,
+            const std::string& sidecar_path) :
+    zip_path(zip_path.data(), zip_path.length()),
+    archive(std::move(archive)),
+    sidecar_path(sidecar_path.data(), sidecar_path.length()) {
+        if (nullptr == this->archive.get() || !this->archive->is_regular_file()) {
+            return;
+        }
+        // archive errors are reported on startup, only the walk is deferred
+        read_end_of_central_dir();
+        auto persisted = load_sidecar();
+        if (nullptr != persisted.get()) {
+            auto promise = std::promise<std::shared_ptr<const void>>();
+            promise.set_value(std::move(persisted));
+            this->table = promise.get_future().share();
+        } else {
+            this->table = std::async(std::launch::async, [this] {
+                return this->build_table();
+            }).share();
+        }
+    }
+
+    zip_index(const zip_index&) = delete;
+
+    zip_index& operator=(const zip_index&) = delete;
+
+    ~zip_index() STATICLIB_NOEXCEPT {
+        if (table.valid()) {
+            // build must not outlive this instance
+            table.wait();
+        }
+    }
+
+    /**
+     * Finds entry by its path inside the archive, waits for
+     * the table to be built on the first call, 'sl::unzip'
+     * is used if the build has failed
+     *
+     * @param path entry path
+     * @return found entry or empty entry
+     */
+    zip_index_entry find(const std::string& path) {
+        if (!table.valid()) {
+            return find_unzip(path);
+        }
+        wait_table();
+        if (table_failed) {
+            return find_unzip(path);
+        }
+        auto res = zip_index_entry();
+        uint64_t hash = zip_index_hash(path.data(), path.length());
+        const char* records = table_data + zip_index_header_size;
+        uint64_t first = 0;
+        uint64_t last = entries_count;
+        while (first < last) {
+            uint64_t mid = first + (last - first) / 2;
+            if (zip_index_load<uint64_t>(records + mid * zip_index_record_size) < hash) {
+                first = mid + 1;
+            } else {
+                last = mid;
+            }
+        }
+        for (uint64_t i = first; i < entries_count; i++) {
+            const char* rec = records + i * zip_index_record_size;
+            if (zip_index_load<uint64_t>(rec) != hash) {
+                break;
+            }
+            auto name_offset = zip_index_load<uint64_t>(rec + 8);
+            auto name_len = zip_index_load<uint32_t>(rec + 16);
+            if (name_len == path.length() &&
+                    0 == std::memcmp(table_data + name_offset, path.data(), path.length())) {
+                res.comp_method = zip_index_load<uint16_t>(rec + 20);
+                res.offset = zip_index_load<uint64_t>(rec + 24);
+                res.comp_length = zip_index_load<uint64_t>(rec + 32);
+                res.uncomp_length = zip_index_load<uint64_t>(rec + 40);
+                res.crc32 = zip_index_load<uint32_t>(rec + 48);
+                res.has_crc32 = true;
+                res.present = true;
+                break;
+            }
+        }
+        return res;
+    }
+
+    /**
+     * Index used to open entry streams with 'sl::unzip',
+     * built on the first call
+     *
+     * @return unzip index
+     */
+    sl::unzip::file_index& unzip_index() {
+        std::call_once(unzip_flag, [this] {
+            this->unzip_idx = std::make_shared<sl::unzip::file_index>(this->zip_path);
+        });
+        return *unzip_idx;
+    }
+
+private:
+    void wait_table() {
+        std::call_once(table_flag, [this] {
+            try {
+                this->table.get();
+            } catch (const std::exception& e) {
+                // reported once, the build is not retried
+                this->table_failed = true;
+                support::log_error("wilton.server", TRACEMSG(e.what() +
+                        "\nZip index build failed, falling back to unzip index, path: [" + this->zip_path + "]"));
+            }
+        });
+    }
+
+    zip_index_entry find_unzip(const std::string& path) {
+        auto res = zip_index_entry();
+        auto en = unzip_index().find_zip_entry(path);
+        if (!en.is_empty()) {
+            res.offset = static_cast<uint64_t>(en.offset);
+            res.comp_length = static_cast<uint64_t>(en.comp_length);
+            res.uncomp_length = static_cast<uint64_t>(en.uncomp_length);
+            res.comp_method = static_cast<uint16_t>(en.comp_method);
+            res.present = true;
+        }
+        return res;
+    }
+
+    std::string read_archive(uint64_t offset, uint64_t len) {
+        auto res = std::string();
+        res.resize(static_cast<size_t>(len));
+        uint64_t pos = 0;
+        while (pos < len) {
+            auto read = archive->read_at({std::addressof(res.front()) + pos, static_cast<size_t>(len - pos)},
+                    offset + pos);
+            if (read <= 0) throw support::exception(TRACEMSG(
+                    "Invalid zip archive, unexpected end of file, path: [" + zip_path + "]"));
+            pos += static_cast<uint64_t>(read);
+        }
+        return res;
+    }
+
+    void read_end_of_central_dir() {
+        uint64_t size = archive->size();
+        if (size < 22) throw support::exception(TRACEMSG(
+                "Invalid zip archive, end of central directory not found, path: [" + zip_path + "]"));
+        // record is 22 bytes followed by up to 64K of comment, zip64 locator precedes it
+        uint64_t tail_len = std::min(size, static_cast<uint64_t>(20 + 22 + 0xffff));
+        uint64_t tail_offset = size - tail_len;
+        auto tail = read_archive(tail_offset, tail_len);
+        const char* data = tail.data();
+        uint64_t min_pos = tail_len > 22 + 0xffff ? tail_len - 22 - 0xffff : 0;
+        uint64_t pos = tail_len - 22;
+        bool found = false;
+        for (;;) {
+            if (0 == std::memcmp(data + pos, "PK\x05\x06", 4)) {
+                found = true;
+                break;
+            }
+            if (pos == min_pos) {
+                break;
+            }
+            pos -= 1;
+        }
+        if (!found) throw support::exception(TRACEMSG(
+                "Invalid zip archive, end of central directory not found, path: [" + zip_path + "]"));
+        entries_count = zip_index_le(data + pos + 10, 2);
+        central_dir_size = zip_index_le(data + pos + 12, 4);
+        central_dir_offset = zip_index_le(data + pos + 16, 4);
+        if ((0xffff == entries_count || 0xffffffff == central_dir_size || 0xffffffff == central_dir_offset) &&
+                pos >= 20 && 0 == std::memcmp(data + pos - 20, "PK\x06\x07", 4)) {
+            uint64_t pos64 = zip_index_le(data + pos - 20 + 8, 8);
+            if (pos64 > size || size - pos64 < 56) throw support::exception(TRACEMSG(
+                    "Invalid zip64 archive, path: [" + zip_path + "]"));
+            auto rec64 = read_archive(pos64, 56);
+            if (0 != std::memcmp(rec64.data(), "PK\x06\x06", 4)) throw support::exception(TRACEMSG(
+                    "Invalid zip64 archive, path: [" + zip_path + "]"));
+            entries_count = zip_index_le(rec64.data() + 32, 8);
+            central_dir_size = zip_index_le(rec64.data() + 40, 8);
+            central_dir_offset = zip_index_le(rec64.data() + 48, 8);
+        }
+        if (central_dir_offset > size || central_dir_size > size - central_dir_offset) throw support::exception(TRACEMSG(
+                "Invalid zip archive, central directory is out of bounds, path: [" + zip_path + "]"));
+    }
+
+    std::shared_ptr<const void> build_table() {
+        // positions below are relative to the central directory start
+        auto central_dir = read_archive(central_dir_offset, central_dir_size);
+        const char* data = central_dir.data();
+        // hash, name position in the central directory, name length, entry
+        using record = std::tuple<uint64_t, uint64_t, uint32_t, zip_index_entry>;
+        auto records = std::vector<record>();
+        records.reserve(static_cast<size_t>(std::min(entries_count, central_dir_size / 46)));
+        uint64_t pos = 0;
+        uint64_t end = central_dir_size;
+        for (uint64_t i = 0; i < entries_count; i++) {
+            if (pos + 46 > end || 0 != std::memcmp(data + pos, "PK\x01\x02", 4)) throw support::exception(TRACEMSG(
+                    "Invalid zip archive, corrupted central directory, path: [" + zip_path + "]"));
+            auto en = zip_index_entry();
+            en.comp_method = static_cast<uint16_t>(zip_index_le(data + pos + 10, 2));
+            en.crc32 = static_cast<uint32_t>(zip_index_le(data + pos + 16, 4));
+            en.has_crc32 = true;
+            en.comp_length = zip_index_le(data + pos + 20, 4);
+            en.uncomp_length = zip_index_le(data + pos + 24, 4);
+            en.offset = zip_index_le(data + pos + 42, 4);
+            en.present = true;
+            auto name_len = zip_index_le(data + pos + 28, 2);
+            auto extra_len = zip_index_le(data + pos + 30, 2);
+            auto comment_len = zip_index_le(data + pos + 32, 2);
+            uint64_t name_pos = pos + 46;
+            if (name_pos + name_len + extra_len + comment_len > end) throw support::exception(TRACEMSG(
+                    "Invalid zip archive, corrupted central directory, path: [" + zip_path + "]"));
+            read_zip64_extra(data + name_pos + name_len, extra_len, en);
+            auto hash = zip_index_hash(data + name_pos, static_cast<size_t>(name_len));
+            records.emplace_back(hash, name_pos, static_cast<uint32_t>(name_len), en);
+            pos = name_pos + name_len + extra_len + comment_len;
+        }
+        std::sort(records.begin(), records.end(), [data](const record& a, const record& b) {
+            if (std::get<0>(a) != std::get<0>(b)) {
+                return std::get<0>(a) < std::get<0>(b);
+            }
+            return std::lexicographical_compare(data + std::get<1>(a), data + std::get<1>(a) + std::get<2>(a),
+                    data + std::get<1>(b), data + std::get<1>(b) + std::get<2>(b));
+        });
+        auto res = std::make_shared<std::string>();
+        uint64_t names_offset = zip_index_header_size + records.size() * zip_index_record_size;
+        res->reserve(static_cast<size_t>(names_offset + central_dir_size));
+        res->append(zip_index_magic, 8);
+        zip_index_store(*res, zip_index_byte_order);
+        zip_index_store(*res, archive->size());
+        zip_index_store(*res, archive->mtime());
+        zip_index_store(*res, static_cast<uint64_t>(records.size()));
+        zip_index_store(*res, names_offset);
+        uint64_t name_offset = names_offset;
+        for (auto& re : records) {
+            auto& en = std::get<3>(re);
+            zip_index_store(*res, std::get<0>(re));
+            zip_index_store(*res, name_offset);
+            zip_index_store(*res, std::get<2>(re));
+            zip_index_store(*res, en.comp_method);
+            zip_index_store(*res, static_cast<uint16_t>(0));
+            zip_index_store(*res, en.offset);
+            zip_index_store(*res, en.comp_length);
+            zip_index_store(*res, en.uncomp_length);
+            zip_index_store(*res, en.crc32);
+            zip_index_store(*res, static_cast<uint32_t>(0));
+            name_offset += std::get<2>(re);
+        }
+        for (auto& re : records) {
+            res->append(data + std::get<1>(re), std::get<2>(re));
+        }
+        entries_count = records.size();
+        table_data = res->data();
+        if (!sidecar_path.empty()) {
+            save_sidecar(*res);
+        }
+        return std::move(res);
+    }
+
+    static void read_zip64_extra(const char* extra, uint64_t extra_len, zip_index_entry& en) {
+        uint64_t pos = 0;
+        while (pos + 4 <= extra_len) {
+            auto id = zip_index_le(extra + pos, 2);
+            auto len = zip_index_le(extra + pos + 2, 2);
+            if (pos + 4 + len > extra_len) {
+                return;
+            }
+            if (0x0001 == id) {
+                const char* field = extra + pos + 4;
+                const char* field_end = field + len;
+                // only fields that do not fit into 32 bits are present, in this order
+                for (auto ptr : { std::addressof(en.uncomp_length), std::addressof(en.comp_length),
+                        std::addressof(en.offset) }) {
+                    if (0xffffffff == *ptr && field + 8 <= field_end) {
+                        *ptr = zip_index_le(field, 8);
+                        field += 8;
+                    }
+                }
+                return;
+            }
+            pos += 4 + len;
+        }
+    }
+
+    std::shared_ptr<const void> load_sidecar() {
+        if (sidecar_path.empty()) {
+            return std::shared_ptr<const void>();
+        }
+        auto mapped = mapped_file::map(native_file::open(sidecar_path));
+        if (nullptr == mapped.get() || mapped->size() < zip_index_header_size) {
+            return std::shared_ptr<const void>();
+        }
+        const char* data = mapped->data();
+        auto count = zip_index_load<uint64_t>(data + 32);
+        auto names_offset = zip_index_load<uint64_t>(data + 40);
+        // stale or foreign index is rebuilt
+        if (0 != std::memcmp(data, zip_index_magic, 8) ||
+                zip_index_byte_order != zip_index_load<uint64_t>(data + 8) ||
+                archive->size() != zip_index_load<uint64_t>(data + 16) ||
+                archive->mtime() != zip_index_load<int64_t>(data + 24) ||
+                count > (mapped->size() - zip_index_header_size) / zip_index_record_size ||
+                names_offset != zip_index_header_size + count * zip_index_record_size) {
+            return std::shared_ptr<const void>();
+        }
+        for (uint64_t i = 0; i < count; i++) {
+            const char* rec = data + zip_index_header_size + i * zip_index_record_size;
+            if (!mapped->contains(zip_index_load<uint64_t>(rec + 8), zip_index_load<uint32_t>(rec + 16))) {
+                return std::shared_ptr<const void>();
+            }
+        }
+        entries_count = count;
+        table_data = data;
+        return std::move(mapped);
+    }
+
+    void save_sidecar(const std::string& contents) {
+        // failure to persist only costs a rebuild on the next start
+        auto tmp_path = sidecar_path + ".tmp";
+        {
+            std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+            out.write(contents.data(), static_cast<std::streamsize>(contents.length()));
+            out.close();
+            if (!out) {
+                std::remove(tmp_path.c_str());
+                return;
+            }
+        }
+        if (0 != std::rename(tmp_path.c_str(), sidecar_path.c_str())) {
+            std::remove(tmp_path.c_str());
+        }
+    }
+
+};
+
+} // namespace
+}
+}
+
+#endif /* WILTON_SERVER_HANDLERS_ZIP_INDEX_HPP */
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   html_escape.hpp
+ * Author: alex
+ *
+ * Created on October 24, 2026, 9:50 AM
+ */
+
+#ifndef WILTON_SERVER_HTML_ESCAPE_HPP
+#define WILTON_SERVER_HTML_ESCAPE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define WILTON_SERVER_HTML_ESCAPE_SSE2
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif // _MSC_VER
+#endif // SSE2
+
+namespace wilton {
+namespace server {
+
+namespace detail_html_escape {
+
+// 1-based replacement index for the bytes that must be escaped
+inline const unsigned char* escape_table() {
+    static const unsigned char table[256] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+        //    !  "  #  $  %  &  '  (  )  *  +  ,  -  .  /
+        0, 0, 4, 0, 0, 0, 1, 5, 0, 0, 0, 0, 0, 0, 0, 6,
+        //                               :  ;  <  =  >  ?
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 3, 0
+        // rest is zero-initialized
+    };
+    return table;
+}
+
+inline void append_replacement(std::string& out, unsigned char idx) {
+    switch (idx) {
+    case 1: out.append("&amp;", 5); break;
+    case 2: out.append("&lt;", 4); break;
+    case 3: out.append("&gt;", 4); break;
+    case 4: out.append("&quot;", 6); break;
+    case 5: out.append("&#39;", 5); break;
+    case 6: out.append("&#x2F;", 6); break;
+    default: break;
+    }
+}
+
+#ifdef WILTON_SERVER_HTML_ESCAPE_SSE2
+inline unsigned first_set_bit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long idx = 0;
+    _BitScanForward(std::addressof(idx), mask);
+    return static_cast<unsigned>(idx);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif // _MSC_VER
+}
+#endif // WILTON_SERVER_HTML_ESCAPE_SSE2
+
+} // namespace
+
+/**
+ * Appends text escaped for HTML, escapes the same characters as mustache
+ * ('&', '<', '>', '"', '\'', '/'); runs of bytes that do not need escaping
+ * are found 16 bytes at a time with SSE2 (when available) and are appended
+ * in bulk
+ *
+ * @param out destination string
+ * @param data text to escape
+ * @param len text length
+ */
+inline void append_html_escaped(std::string& out, const char* data, size_t len) {
+    auto table = detail_html_escape::escape_table();
+    size_t i = 0;
+    // clean run start
+    size_t run = 0;
+#ifdef WILTON_SERVER_HTML_ESCAPE_SSE2
+    const __m128i amp = _mm_set1_epi8('&');
+    const __m128i lt = _mm_set1_epi8('<');
+    const __m128i gt = _mm_set1_epi8('>');
+    const __m128i quot = _mm_set1_epi8('"');
+    const __m128i apos = _mm_set1_epi8('\'');
+    const __m128i slash = _mm_set1_epi8('/');
+    while (i + 16 <= len) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i hits = _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, amp), _mm_cmpeq_epi8(chunk, lt)),
+                _mm_or_si128(
+                        _mm_or_si128(_mm_cmpeq_epi8(chunk, gt), _mm_cmpeq_epi8(chunk, quot)),
+                        _mm_or_si128(_mm_cmpeq_epi8(chunk, apos), _mm_cmpeq_epi8(chunk, slash))));
+        auto mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+        if (0 == mask) {
+            i += 16;
+            continue;
+        }
+        while (0 != mask) {
+            size_t pos = i + detail_html_escape::first_set_bit(mask);
+            out.append(data + run, pos - run);
+            detail_html_escape::append_replacement(out, table[static_cast<unsigned char>(data[pos])]);
+            run = pos + 1;
+            mask &= mask - 1;
+        }
+        i += 16;
+    }
+#endif // WILTON_SERVER_HTML_ESCAPE_SSE2
+    for (; i < len; i++) {
+        unsigned char idx = table[static_cast<unsigned char>(data[i])];
+        if (0 != idx) {
+            out.append(data + run, i - run);
+            detail_html_escape::append_replacement(out, idx);
+            run = i + 1;
+        }
+    }
+    out.append(data + run, len - run);
+}
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_HTML_ESCAPE_HPP */
@@ -0,0 +1,245 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   http_conditional.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 11:02 AM
+ */
+
+#ifndef WILTON_SERVER_HTTP_CONDITIONAL_HPP
+#define WILTON_SERVER_HTTP_CONDITIONAL_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <array>
+#include <string>
+
+#include "staticlib/pion.hpp"
+#include "staticlib/support.hpp"
+
+namespace wilton {
+namespace server {
+
+namespace { // anonymous
+
+const std::array<const char*, 7> http_date_days = {{
+    "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"
+}};
+
+const std::array<const char*, 12> http_date_months = {{
+    "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+}};
+
+std::string to_hex(uint64_t num) {
+    static const char* digits = "0123456789abcdef";
+    if (0 == num) {
+        return std::string("0");
+    }
+    auto res = std::string();
+    while (num > 0) {
+        res.insert(res.begin(), digits[num & 0xf]);
+        num >>= 4;
+    }
+    return res;
+}
+
+// days since 1970-01-01, proleptic Gregorian calendar
+int64_t days_from_civil(int64_t y, unsigned m, unsigned d) {
+    y -= m <= 2 ? 1 : 0;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    unsigned yoe = static_cast<unsigned>(y - era * 400);
+    unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+} // namespace
+
+/**
+ * Strong entity tag for a file on disk
+ *
+ * @param inode file inode
+ * @param size file size
+ * @param mtime modification time in seconds
+ * @return quoted entity tag
+ */
+inline std::string make_file_etag(uint64_t inode, uint64_t size, int64_t mtime) {
+    return "\"" + to_hex(inode) + "-" + to_hex(size) + "-" + to_hex(static_cast<uint64_t>(mtime)) + "\"";
+}
+
+/**
+ * Strong entity tag for a zip entry
+ *
+ * @param crc32 entry checksum
+ * @param size uncompressed entry size
+ * @return quoted entity tag
+ */
+inline std::string make_zip_etag(uint32_t crc32, uint64_t size) {
+    return "\"z" + to_hex(crc32) + "-" + to_hex(size) + "\"";
+}
+
+/**
+ * Strong entity tag for an in-memory body without other metadata
+ *
+ * @param data body contents
+ * @param len body length
+ * @return quoted entity tag
+ */
+inline std::string make_content_etag(const char* data, size_t len) {
+    // FNV-1a
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < len; i++) {
+        hash ^= static_cast<uint8_t>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return "\"c" + to_hex(hash) + "-" + to_hex(len) + "\"";
+}
+
+/**
+ * Formats time as an IMF-fixdate, e.g. 'Sun, 06 Nov 1994 08:49:37 GMT'
+ *
+ * @param secs seconds since epoch
+ * @return formatted date
+ */
+inline std::string format_http_date(int64_t secs) {
+    std::time_t tt = static_cast<std::time_t>(secs);
+    struct tm tm;
+#ifdef STATICLIB_WINDOWS
+    if (0 != gmtime_s(std::addressof(tm), std::addressof(tt))) return std::string();
+#else
+    if (nullptr == gmtime_r(std::addressof(tt), std::addressof(tm))) return std::string();
+#endif // STATICLIB_WINDOWS
+    auto buf = std::array<char, 32>();
+    std::snprintf(buf.data(), buf.size(), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+            http_date_days[tm.tm_wday % 7], tm.tm_mday, http_date_months[tm.tm_mon % 12],
+            tm.tm_year + 1900, tm.tm_hour, tm.tm_min, tm.tm_sec);
+    return std::string(buf.data());
+}
+
+/**
+ * Parses IMF-fixdate, obsolete date formats are not supported
+ *
+ * @param date formatted date
+ * @return seconds since epoch or -1 on error
+ */
+inline int64_t parse_http_date(const std::string& date) {
+    auto day_name = std::array<char, 4>();
+    auto month_name = std::array<char, 4>();
+    int day = 0, year = 0, hour = 0, minute = 0, second = 0;
+    int parsed = std::sscanf(date.c_str(), "%3s, %d %3s %d %d:%d:%d GMT", day_name.data(), std::addressof(day),
+            month_name.data(), std::addressof(year), std::addressof(hour), std::addressof(minute),
+            std::addressof(second));
+    if (7 != parsed) {
+        return -1;
+    }
+    unsigned month = 0;
+    while (month < http_date_months.size() && 0 != std::strcmp(http_date_months[month], month_name.data())) {
+        month++;
+    }
+    if (month >= http_date_months.size() || day < 1 || day > 31 || year < 1970 ||
+            hour > 23 || minute > 59 || second > 60) {
+        return -1;
+    }
+    int64_t days = days_from_civil(year, month + 1, static_cast<unsigned>(day));
+    return days * 86400 + hour * 3600 + minute * 60 + second;
+}
+
+/**
+ * Checks 'If-None-Match' and 'If-Modified-Since' request headers,
+ * 'If-Modified-Since' is ignored when 'If-None-Match' is present
+ *
+ * @param req HTTP request
+ * @param etag current strong entity tag
+ * @param mtime modification time in seconds, or -1 if unknown
+ * @return true if '304 Not Modified' must be sent
+ */
+inline bool is_not_modified(const sl::pion::http_request& req, const std::string& etag, int64_t mtime) {
+    const std::string& inm = req.get_header("If-None-Match");
+    if (!inm.empty()) {
+        if (etag.empty()) {
+            return false;
+        }
+        // weak comparison
+        size_t pos = 0;
+        while (pos < inm.length()) {
+            auto comma = inm.find(',', pos);
+            if (std::string::npos == comma) {
+                comma = inm.length();
+            }
+            auto first = inm.find_first_not_of(" \t", pos);
+            if (first < comma) {
+                auto last = inm.find_last_not_of(" \t", comma - 1);
+                auto tag = inm.substr(first, last - first + 1);
+                if ("*" == tag) {
+                    return true;
+                }
+                if (0 == tag.compare(0, 2, "W/")) {
+                    tag = tag.substr(2);
+                }
+                if (tag == etag) {
+                    return true;
+                }
+            }
+            pos = comma + 1;
+        }
+        return false;
+    }
+    const std::string& ims = req.get_header("If-Modified-Since");
+    if (ims.empty() || mtime < 0) {
+        return false;
+    }
+    int64_t since = parse_http_date(ims);
+    return since >= 0 && mtime <= since;
+}
+
+/**
+ * Sets 'ETag' and 'Last-Modified' response headers
+ *
+ * @param resp HTTP response
+ * @param etag entity tag, not set if empty
+ * @param last_modified formatted date, not set if empty
+ */
+inline void set_validator_headers(sl::pion::http_response& resp, const std::string& etag,
+        const std::string& last_modified) {
+    if (!etag.empty()) {
+        resp.change_header("ETag", etag);
+    }
+    if (!last_modified.empty()) {
+        resp.change_header("Last-Modified", last_modified);
+    }
+}
+
+/**
+ * Sends bodiless '304 Not Modified' response, validator and
+ * caching headers must be already set
+ *
+ * @param resp response writer
+ */
+inline void send304(sl::pion::response_writer_ptr resp) {
+    auto& rp = resp->get_response();
+    rp.set_status_code(304);
+    rp.set_status_message("Not Modified");
+    resp->send(std::move(resp));
+}
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_HTTP_CONDITIONAL_HPP */
@@ -0,0 +1,404 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   http_range.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 3:10 PM
+ */
+
+#ifndef WILTON_SERVER_HTTP_RANGE_HPP
+#define WILTON_SERVER_HTTP_RANGE_HPP
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <ios>
+#include <istream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "staticlib/io.hpp"
+#include "staticlib/pion.hpp"
+#include "staticlib/support.hpp"
+#include "staticlib/utils.hpp"
+
+namespace wilton {
+namespace server {
+
+namespace { // anonymous
+
+// larger sets of ranges are ignored and full body is sent
+const size_t max_ranges_count = 32;
+
+const std::string byteranges_boundary_prefix = "wilton_byteranges_";
+
+} // namespace
+
+/**
+ * Inclusive byte range within a response body
+ */
+class byte_range {
+public:
+    uint64_t first;
+    uint64_t last;
+
+    byte_range(uint64_t first, uint64_t last) :
+    first(first),
+    last(last) { }
+
+    uint64_t length() const {
+        return last - first + 1;
+    }
+};
+
+enum class range_status {
+    absent, satisfiable, unsatisfiable
+};
+
+/**
+ * Reads up to 'span.size()' bytes of body at the specified offset,
+ * returns the number of bytes read, or non-positive value on error
+ */
+using positional_reader = std::function<std::streamsize(sl::io::span<char>, uint64_t)>;
+
+/**
+ * Parses 'Range' header value, ranges are sorted and overlapping
+ * or adjacent ranges are coalesced, syntactically invalid values
+ * are ignored as specified by RFC 7233
+ *
+ * @param header 'Range' header value
+ * @param size full body size
+ * @param out output ranges
+ * @return parsing status
+ */
+inline range_status parse_range_header(const std::string& header, uint64_t size,
+        std::vector<byte_range>& out) {
+    static const std::string unit = "bytes=";
+    out.clear();
+    if (!sl::utils::starts_with(header, unit)) {
+        return range_status::absent;
+    }
+    auto trim = [](const std::string& st) -> std::string {
+        auto first = st.find_first_not_of(" \t");
+        if (std::string::npos == first) return std::string();
+        auto last = st.find_last_not_of(" \t");
+        return st.substr(first, last - first + 1);
+    };
+    bool invalid = false;
+    auto parse_num = [&invalid](const std::string& st) -> uint64_t {
+        if (st.empty() || st.length() > 19 ||
+                std::string::npos != st.find_first_not_of("0123456789")) {
+            invalid = true;
+            return 0;
+        }
+        return static_cast<uint64_t>(std::strtoull(st.c_str(), nullptr, 10));
+    };
+    size_t specs_count = 0;
+    size_t start = unit.length();
+    while (start <= header.length()) {
+        auto comma = header.find(',', start);
+        if (std::string::npos == comma) {
+            comma = header.length();
+        }
+        auto spec = trim(header.substr(start, comma - start));
+        start = comma + 1;
+        if (spec.empty()) continue;
+        specs_count += 1;
+        if (specs_count > max_ranges_count) {
+            return range_status::absent;
+        }
+        auto dash = spec.find('-');
+        if (std::string::npos == dash) {
+            return range_status::absent;
+        }
+        auto first_st = trim(spec.substr(0, dash));
+        auto last_st = trim(spec.substr(dash + 1));
+        if (first_st.empty()) {
+            // suffix range
+            uint64_t suffix = parse_num(last_st);
+            if (invalid) return range_status::absent;
+            if (0 == suffix || 0 == size) continue;
+            uint64_t first = suffix < size ? size - suffix : 0;
+            out.emplace_back(first, size - 1);
+        } else {
+            uint64_t first = parse_num(first_st);
+            uint64_t last = last_st.empty() ? 0 : parse_num(last_st);
+            if (invalid) return range_status::absent;
+            if (!last_st.empty() && last < first) return range_status::absent;
+            if (first >= size) continue;
+            out.emplace_back(first, last_st.empty() ? size - 1 : std::min(last, size - 1));
+        }
+    }
+    if (0 == specs_count) {
+        return range_status::absent;
+    }
+    if (out.empty()) {
+        return range_status::unsatisfiable;
+    }
+    std::sort(out.begin(), out.end(), [](const byte_range& a, const byte_range& b) {
+        return a.first < b.first;
+    });
+    auto coalesced = std::vector<byte_range>();
+    for (auto& ra : out) {
+        if (!coalesced.empty() && ra.first <= coalesced.back().last + 1) {
+            coalesced.back().last = std::max(coalesced.back().last, ra.last);
+        } else {
+            coalesced.push_back(ra);
+        }
+    }
+    out = std::move(coalesced);
+    return range_status::satisfiable;
+}
+
+/**
+ * Checks 'If-Range' precondition, weak entity tags never match
+ *
+ * @param if_range 'If-Range' header value
+ * @param etag current strong entity tag, may be empty
+ * @param last_modified current 'Last-Modified' value, may be empty
+ * @return true if 'Range' must be processed
+ */
+inline bool if_range_matches(const std::string& if_range, const std::string& etag,
+        const std::string& last_modified) {
+    if (if_range.empty()) {
+        return true;
+    }
+    if (!etag.empty() && if_range == etag) {
+        return true;
+    }
+    return !last_modified.empty() && if_range == last_modified;
+}
+
+/**
+ * Checks 'Range' and 'If-Range' request headers
+ *
+ * @param req HTTP request
+ * @param size full body size
+ * @param etag current strong entity tag, may be empty
+ * @param last_modified current 'Last-Modified' value, may be empty
+ * @param out output ranges
+ * @return parsing status
+ */
+inline range_status read_request_ranges(const sl::pion::http_request& req, uint64_t size,
+        const std::string& etag, const std::string& last_modified, std::vector<byte_range>& out) {
+    if ("GET" != req.get_method()) {
+        return range_status::absent;
+    }
+    const std::string& range = req.get_header("Range");
+    if (range.empty()) {
+        return range_status::absent;
+    }
+    if (!if_range_matches(req.get_header("If-Range"), etag, last_modified)) {
+        return range_status::absent;
+    }
+    return parse_range_header(range, size, out);
+}
+
+/**
+ * Body of a '206 Partial Content' response, single range is
+ * sent as is, multiple ranges are wrapped into 'multipart/byteranges'
+ */
+class byte_ranges_source {
+    positional_reader reader;
+    std::vector<byte_range> ranges;
+    std::vector<std::string> preambles;
+    std::string closing;
+
+    size_t idx = 0;
+    size_t str_pos = 0;
+    uint64_t data_pos = 0;
+    bool in_data = false;
+    bool failed = false;
+
+public:
+    byte_ranges_source(positional_reader reader, std::vector<byte_range> ranges,
+            const std::string& boundary, const std::string& content_type, uint64_t size) :
+    reader(std::move(reader)),
+    ranges(std::move(ranges)) {
+        if (this->ranges.size() > 1) {
+            for (auto& ra : this->ranges) {
+                preambles.emplace_back("\r\n--" + boundary + "\r\n" +
+                        "Content-Type: " + content_type + "\r\n" +
+                        "Content-Range: " + content_range(ra, size) + "\r\n\r\n");
+            }
+            closing = "\r\n--" + boundary + "--\r\n";
+        } else {
+            preambles.emplace_back("");
+        }
+    }
+
+    byte_ranges_source(const byte_ranges_source&) = delete;
+
+    byte_ranges_source& operator=(const byte_ranges_source&) = delete;
+
+    byte_ranges_source(byte_ranges_source&& other) :
+    reader(std::move(other.reader)),
+    ranges(std::move(other.ranges)),
+    preambles(std::move(other.preambles)),
+    closing(std::move(other.closing)),
+    idx(other.idx),
+    str_pos(other.str_pos),
+    data_pos(other.data_pos),
+    in_data(other.in_data),
+    failed(other.failed) { }
+
+    byte_ranges_source& operator=(byte_ranges_source&&) = delete;
+
+    uint64_t total_length() const {
+        uint64_t res = closing.length();
+        for (size_t i = 0; i < ranges.size(); i++) {
+            res += preambles[i].length() + ranges[i].length();
+        }
+        return res;
+    }
+
+    std::streamsize read(sl::io::span<char> span) {
+        size_t written = 0;
+        while (written < span.size() && !failed) {
+            if (idx < ranges.size()) {
+                if (!in_data) {
+                    written += copy_str(preambles[idx], span, written);
+                    if (str_pos == preambles[idx].length()) {
+                        str_pos = 0;
+                        in_data = true;
+                    }
+                } else {
+                    auto& ra = ranges[idx];
+                    uint64_t remaining = ra.length() - data_pos;
+                    if (0 == remaining) {
+                        idx += 1;
+                        data_pos = 0;
+                        in_data = false;
+                        continue;
+                    }
+                    size_t avail = span.size() - written;
+                    size_t len = remaining < avail ? static_cast<size_t>(remaining) : avail;
+                    auto res = reader({span.data() + written, len}, ra.first + data_pos);
+                    if (res <= 0) {
+                        // body changed after headers were sent
+                        failed = true;
+                        break;
+                    }
+                    data_pos += static_cast<uint64_t>(res);
+                    written += static_cast<size_t>(res);
+                }
+            } else {
+                written += copy_str(closing, span, written);
+                if (str_pos == closing.length()) break;
+            }
+        }
+        if (0 == written) {
+            return std::char_traits<char>::eof();
+        }
+        return static_cast<std::streamsize>(written);
+    }
+
+    static std::string content_range(const byte_range& ra, uint64_t size) {
+        return "bytes " + sl::support::to_string(ra.first) + "-" + sl::support::to_string(ra.last) +
+                "/" + sl::support::to_string(size);
+    }
+
+    static std::string generate_boundary() {
+        static std::atomic<uint64_t> counter{0};
+        auto num = counter.fetch_add(1, std::memory_order_relaxed);
+        return byteranges_boundary_prefix + sl::support::to_string(num);
+    }
+
+private:
+    size_t copy_str(const std::string& str, sl::io::span<char> span, size_t written) {
+        size_t avail = span.size() - written;
+        size_t left = str.length() - str_pos;
+        size_t len = std::min(avail, left);
+        std::memcpy(span.data() + written, str.data() + str_pos, len);
+        str_pos += len;
+        return len;
+    }
+};
+
+/**
+ * Forward-only positional reader over a sequential stream,
+ * offsets must be requested in ascending order
+ *
+ * @param stream input stream
+ * @return reader
+ */
+inline positional_reader make_sequential_reader(std::unique_ptr<std::istream> stream) {
+    auto st = std::shared_ptr<std::istream>(stream.release());
+    auto pos = std::make_shared<uint64_t>(0);
+    return [st, pos](sl::io::span<char> span, uint64_t offset) -> std::streamsize {
+        if (offset < *pos) {
+            return -1;
+        }
+        if (offset > *pos) {
+            st->ignore(static_cast<std::streamsize>(offset - *pos));
+            *pos += static_cast<uint64_t>(st->gcount());
+            if (offset != *pos) {
+                return -1;
+            }
+        }
+        st->read(span.data(), static_cast<std::streamsize>(span.size()));
+        auto res = st->gcount();
+        *pos += static_cast<uint64_t>(res);
+        return res;
+    };
+}
+
+/**
+ * Sets '206 Partial Content' status and headers, 'Content-Type' must
+ * be already set to the content type of the full body
+ *
+ * @param resp HTTP response
+ * @param ranges non-empty list of ranges
+ * @param size full body size
+ * @return multipart boundary or empty string for a single range
+ */
+inline std::string set_partial_headers(sl::pion::http_response& resp, const std::vector<byte_range>& ranges,
+        uint64_t size) {
+    resp.set_status_code(206);
+    resp.set_status_message("Partial Content");
+    if (1 == ranges.size()) {
+        resp.change_header("Content-Range", byte_ranges_source::content_range(ranges.front(), size));
+        return std::string();
+    }
+    auto boundary = byte_ranges_source::generate_boundary();
+    resp.change_header("Content-Type", "multipart/byteranges; boundary=" + boundary);
+    return boundary;
+}
+
+/**
+ * Sends '416 Range Not Satisfiable' response
+ *
+ * @param resp response writer
+ * @param size full body size
+ */
+inline void send416(sl::pion::response_writer_ptr resp, uint64_t size) {
+    auto& rp = resp->get_response();
+    rp.set_status_code(416);
+    rp.set_status_message("Range Not Satisfiable");
+    rp.change_header("Content-Range", "bytes */" + sl::support::to_string(size));
+    resp->send(std::move(resp));
+}
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_HTTP_RANGE_HPP */
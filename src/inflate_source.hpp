@@ -0,0 +1,152 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   inflate_source.hpp
+ * Author: alex
+ *
+ * Created on October 20, 2026, 11:40 AM
+ */
+
+#ifndef WILTON_SERVER_INFLATE_SOURCE_HPP
+#define WILTON_SERVER_INFLATE_SOURCE_HPP
+
+// zlib is linked directly only where 'native_file' is supported
+#ifndef STATICLIB_WINDOWS
+
+#include <cstdint>
+#include <algorithm>
+#include <ios>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "zlib.h"
+
+#include "staticlib/config.hpp"
+#include "staticlib/io.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "native_file.hpp"
+
+namespace wilton {
+namespace server {
+
+namespace { // anonymous
+
+const size_t inflate_source_buffer_size = 65536;
+
+} // namespace
+
+/**
+ * Source that inflates raw DEFLATE data (zip method 8) read
+ * positionally from the archive, without 'sl::unzip' stream setup;
+ * truncated archive results in an error instead of a fault
+ */
+class inflate_source {
+    std::shared_ptr<native_file> archive;
+    // zlib state keeps a pointer to the stream, so it is not moved
+    std::unique_ptr<z_stream> strm;
+    std::vector<char> buf;
+    uint64_t next_offset;
+    uint64_t remaining_in;
+    bool finished = false;
+
+public:
+    inflate_source(std::shared_ptr<native_file> archive, uint64_t offset, uint64_t length) :
+    archive(std::move(archive)),
+    strm(new z_stream()),
+    buf(static_cast<size_t>(std::min(length, static_cast<uint64_t>(inflate_source_buffer_size)))),
+    next_offset(offset),
+    remaining_in(length) {
+        if (Z_OK != ::inflateInit2(strm.get(), -MAX_WBITS)) {
+            strm.reset();
+            throw support::exception(TRACEMSG("Inflater initialization error"));
+        }
+    }
+
+    inflate_source(const inflate_source&) = delete;
+
+    inflate_source& operator=(const inflate_source&) = delete;
+
+    inflate_source(inflate_source&& other) :
+    archive(std::move(other.archive)),
+    strm(std::move(other.strm)),
+    buf(std::move(other.buf)),
+    next_offset(other.next_offset),
+    remaining_in(other.remaining_in),
+    finished(other.finished) { }
+
+    inflate_source& operator=(inflate_source&&) = delete;
+
+    ~inflate_source() STATICLIB_NOEXCEPT {
+        if (nullptr != strm.get()) {
+            ::inflateEnd(strm.get());
+        }
+    }
+
+    std::streamsize read(sl::io::span<char> span) {
+        if (finished) {
+            return std::char_traits<char>::eof();
+        }
+        if (0 == span.size()) {
+            return 0;
+        }
+        auto avail = static_cast<uInt>(std::min(span.size(),
+                static_cast<size_t>(std::numeric_limits<uInt>::max())));
+        strm->next_out = reinterpret_cast<Bytef*>(span.data());
+        strm->avail_out = avail;
+        while (strm->avail_out == avail) {
+            if (0 == strm->avail_in && remaining_in > 0) {
+                auto chunk = static_cast<size_t>(std::min(remaining_in, static_cast<uint64_t>(buf.size())));
+                auto read = archive->read_at({buf.data(), chunk}, next_offset);
+                if (read <= 0) {
+                    throw support::exception(TRACEMSG("Compressed data is truncated"));
+                }
+                strm->next_in = reinterpret_cast<Bytef*>(buf.data());
+                strm->avail_in = static_cast<uInt>(read);
+                next_offset += static_cast<uint64_t>(read);
+                remaining_in -= static_cast<uint64_t>(read);
+            }
+            auto err = ::inflate(strm.get(), Z_NO_FLUSH);
+            if (Z_STREAM_END == err) {
+                finished = true;
+                break;
+            }
+            if (Z_OK != err) {
+                throw support::exception(TRACEMSG("Invalid compressed data, code: [" + sl::support::to_string(err) + "]"));
+            }
+            if (0 == strm->avail_in && 0 == remaining_in && strm->avail_out == avail) {
+                throw support::exception(TRACEMSG("Compressed data is truncated"));
+            }
+        }
+        auto produced = static_cast<std::streamsize>(avail - strm->avail_out);
+        if (0 == produced && finished) {
+            return std::char_traits<char>::eof();
+        }
+        return produced;
+    }
+};
+
+} // namespace
+}
+
+#endif // !STATICLIB_WINDOWS
+
+#endif /* WILTON_SERVER_INFLATE_SOURCE_HPP */
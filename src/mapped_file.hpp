@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   mapped_file.hpp
+ * Author: alex
+ *
+ * Created on October 20, 2026, 11:05 AM
+ */
+
+#ifndef WILTON_SERVER_MAPPED_FILE_HPP
+#define WILTON_SERVER_MAPPED_FILE_HPP
+
+#include <cstdint>
+#include <memory>
+
+#ifndef STATICLIB_WINDOWS
+#include <sys/mman.h>
+#endif // !STATICLIB_WINDOWS
+
+#include "staticlib/config.hpp"
+
+#include "native_file.hpp"
+
+namespace wilton {
+namespace server {
+
+/**
+ * Read-only shared mapping of the whole 'native_file', single
+ * instance is shared between IO threads; file must not be truncated
+ * while it is mapped
+ */
+class mapped_file {
+    std::shared_ptr<native_file> file;
+    const char* addr;
+    uint64_t length;
+
+public:
+    mapped_file(std::shared_ptr<native_file> file, const char* addr, uint64_t length) :
+    file(std::move(file)),
+    addr(addr),
+    length(length) { }
+
+    mapped_file(const mapped_file&) = delete;
+
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    ~mapped_file() STATICLIB_NOEXCEPT {
+#ifndef STATICLIB_WINDOWS
+        ::munmap(const_cast<char*>(addr), static_cast<size_t>(length));
+#endif // !STATICLIB_WINDOWS
+    }
+
+    /**
+     * Maps specified file into memory
+     *
+     * @param file opened file
+     * @return mapping or null if file is not a regular non-empty
+     *         file or cannot be mapped on this platform
+     */
+    static std::shared_ptr<mapped_file> map(std::shared_ptr<native_file> file) {
+#ifndef STATICLIB_WINDOWS
+        if (nullptr == file.get() || !file->is_regular_file() || 0 == file->size()) {
+            return std::shared_ptr<mapped_file>();
+        }
+        auto len = static_cast<size_t>(file->size());
+        auto ptr = ::mmap(nullptr, len, PROT_READ, MAP_SHARED, file->handle(), 0);
+        if (MAP_FAILED == ptr) {
+            return std::shared_ptr<mapped_file>();
+        }
+        auto addr = static_cast<const char*>(ptr);
+        return std::make_shared<mapped_file>(std::move(file), addr, static_cast<uint64_t>(len));
+#else
+        (void) file;
+        return std::shared_ptr<mapped_file>();
+#endif // !STATICLIB_WINDOWS
+    }
+
+    const char* data() const {
+        return addr;
+    }
+
+    uint64_t size() const {
+        return length;
+    }
+
+    /**
+     * Checks that specified byte range lies within the mapping
+     *
+     * @param offset range start
+     * @param count range length
+     * @return true if range is mapped
+     */
+    bool contains(uint64_t offset, uint64_t count) const {
+        return offset <= length && count <= length - offset;
+    }
+};
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_MAPPED_FILE_HPP */
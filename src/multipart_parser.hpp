@@ -0,0 +1,442 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   multipart_parser.hpp
+ * Author: alex
+ *
+ * Created on October 25, 2026, 10:10 AM
+ */
+
+#ifndef WILTON_SERVER_MULTIPART_PARSER_HPP
+#define WILTON_SERVER_MULTIPART_PARSER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "staticlib/config.hpp"
+#include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+#include "staticlib/tinydir.hpp"
+
+#include "wilton/support/exception.hpp"
+
+namespace wilton {
+namespace server {
+
+/**
+ * Part of 'multipart/form-data' body, parts with 'filename' in
+ * 'Content-Disposition' are written to temporary files, other parts
+ * are kept in memory
+ */
+class multipart_part {
+public:
+    std::string name;
+    std::string filename;
+    std::string content_type;
+    bool is_file = false;
+    uint64_t size = 0;
+    // text field value
+    std::string value;
+    // temporary file with part contents
+    std::string path;
+    std::unique_ptr<sl::tinydir::file_sink> file;
+};
+
+/**
+ * Incremental parser of 'multipart/form-data' bodies (RFC 7578),
+ * body is consumed in arbitrary parts as they are received from
+ * the network, file parts are spooled to disk without buffering
+ * them whole
+ */
+class multipart_parser {
+    enum class parser_state {
+        preamble, delimiter, headers, body, epilogue
+    };
+
+    // max size of headers of a single part
+    static const size_t max_headers_len = 16384;
+    // max number of parts in a body, each file part is a temporary file
+    static const size_t max_parts = 1024;
+
+    std::string dash_boundary;
+    std::string body_delimiter;
+    uint32_t fields_limit;
+    std::function<std::string()> tmp_path_gen;
+
+    parser_state state = parser_state::preamble;
+    // received bytes that cannot be processed yet
+    std::string pending;
+    uint64_t fields_bytes = 0;
+    std::vector<multipart_part> parts_list;
+
+public:
+    /**
+     * Constructor
+     *
+     * @param boundary boundary from 'Content-Type' header
+     * @param fields_limit max total size of text fields and part headers
+     * @param tmp_path_gen generates paths for temporary files
+     */
+    multipart_parser(const std::string& boundary, uint32_t fields_limit,
+            std::function<std::string()> tmp_path_gen) :
+    dash_boundary("--" + boundary),
+    body_delimiter("\r\n--" + boundary),
+    fields_limit(fields_limit),
+    tmp_path_gen(std::move(tmp_path_gen)) { }
+
+    multipart_parser(const multipart_parser&) = delete;
+
+    multipart_parser& operator=(const multipart_parser&) = delete;
+
+    ~multipart_parser() STATICLIB_NOEXCEPT {
+        for (auto& pa : parts_list) {
+            pa.file.reset();
+            if (!pa.path.empty()) {
+                std::remove(pa.path.c_str());
+            }
+        }
+    }
+
+    /**
+     * Extracts boundary from 'Content-Type' header value
+     *
+     * @param content_type header value
+     * @return boundary or empty string if content type
+     *         is not 'multipart/form-data'
+     */
+    static std::string extract_boundary(const std::string& content_type) {
+        auto semicolon = content_type.find(';');
+        auto mime = lower(trim(content_type.substr(0, semicolon)));
+        if ("multipart/form-data" != mime || std::string::npos == semicolon) {
+            return std::string();
+        }
+        auto res = header_param(content_type.substr(semicolon), "boundary");
+        // RFC 2046 limit
+        if (res.length() > 70) {
+            return std::string();
+        }
+        return res;
+    }
+
+    /**
+     * Consumes next part of the body
+     *
+     * @param data body bytes
+     * @param len number of bytes
+     */
+    void consume(const char* data, size_t len) {
+        if (parser_state::epilogue == state) {
+            return;
+        }
+        pending.append(data, len);
+        while (step()) { }
+    }
+
+    /**
+     * Checks that final boundary was received
+     *
+     * @return true if the whole body was parsed
+     */
+    bool is_complete() const {
+        return parser_state::epilogue == state;
+    }
+
+    const std::vector<multipart_part>& parts() const {
+        return parts_list;
+    }
+
+    /**
+     * Text fields as an object, the same as for urlencoded forms
+     *
+     * @return fields JSON
+     */
+    sl::json::value fields_json() const {
+        auto res = std::vector<sl::json::field>();
+        for (auto& pa : parts_list) {
+            if (!pa.is_file) {
+                res.emplace_back(pa.name, pa.value);
+            }
+        }
+        return sl::json::value(std::move(res));
+    }
+
+    /**
+     * Text fields and file parts descriptions
+     *
+     * @return parts JSON
+     */
+    sl::json::value to_json() const {
+        auto files = std::vector<sl::json::value>();
+        for (auto& pa : parts_list) {
+            if (pa.is_file) {
+                files.emplace_back(sl::json::value({
+                    { "name", pa.name },
+                    { "filename", pa.filename },
+                    { "contentType", pa.content_type },
+                    { "size", pa.size },
+                    { "path", pa.path }
+                }));
+            }
+        }
+        return {
+            { "fields", fields_json() },
+            { "files", std::move(files) }
+        };
+    }
+
+private:
+    // returns false when more data is needed
+    bool step() {
+        switch (state) {
+        case parser_state::preamble: {
+            auto pos = pending.find(dash_boundary);
+            if (std::string::npos == pos) {
+                keep_tail(dash_boundary.length() - 1);
+                return false;
+            }
+            pending.erase(0, pos + dash_boundary.length());
+            state = parser_state::delimiter;
+            return true;
+        }
+        case parser_state::delimiter: {
+            if (pending.length() < 2) {
+                return false;
+            }
+            if (0 == pending.compare(0, 2, "--")) {
+                pending.clear();
+                state = parser_state::epilogue;
+                return false;
+            }
+            // transport padding (RFC 2046) is allowed before the line end
+            auto pos = pending.find_first_not_of(" \t");
+            if (std::string::npos == pos || pending.length() < pos + 2) {
+                if (pending.length() > max_headers_len) throw support::exception(TRACEMSG(
+                        "Invalid 'multipart/form-data' body, invalid boundary line"));
+                return false;
+            }
+            if (0 != pending.compare(pos, 2, "\r\n")) throw support::exception(TRACEMSG(
+                    "Invalid 'multipart/form-data' body, invalid boundary line"));
+            pending.erase(0, pos + 2);
+            state = parser_state::headers;
+            return true;
+        }
+        case parser_state::headers: {
+            size_t end = 0;
+            if (0 == pending.compare(0, 2, "\r\n")) {
+                end = 0;
+            } else {
+                auto pos = pending.find("\r\n\r\n");
+                if (std::string::npos == pos) {
+                    if (pending.length() > max_headers_len) throw support::exception(TRACEMSG(
+                            "Invalid 'multipart/form-data' body, part headers are too long"));
+                    return false;
+                }
+                end = pos + 2;
+            }
+            if (end > max_headers_len) throw support::exception(TRACEMSG(
+                    "Invalid 'multipart/form-data' body, part headers are too long"));
+            if (parts_list.size() >= max_parts) throw support::exception(TRACEMSG(
+                    "Invalid 'multipart/form-data' body, too many parts, limit: [" +
+                    sl::support::to_string(static_cast<uint64_t>(max_parts)) + "]"));
+            // headers of file parts are kept in memory too
+            count_fields_bytes(end + 2);
+            start_part(pending.substr(0, end));
+            pending.erase(0, end + 2);
+            state = parser_state::body;
+            return true;
+        }
+        case parser_state::body: {
+            auto pos = pending.find(body_delimiter);
+            if (std::string::npos == pos) {
+                if (pending.length() >= body_delimiter.length()) {
+                    // tail may hold the beginning of delimiter
+                    size_t ready = pending.length() - (body_delimiter.length() - 1);
+                    append_body(pending.data(), ready);
+                    pending.erase(0, ready);
+                }
+                return false;
+            }
+            append_body(pending.data(), pos);
+            finish_part();
+            pending.erase(0, pos + body_delimiter.length());
+            state = parser_state::delimiter;
+            return true;
+        }
+        default:
+            return false;
+        }
+    }
+
+    void keep_tail(size_t len) {
+        if (pending.length() > len) {
+            pending.erase(0, pending.length() - len);
+        }
+    }
+
+    void start_part(const std::string& headers) {
+        auto pa = multipart_part();
+        size_t pos = 0;
+        while (pos < headers.length()) {
+            auto eol = headers.find("\r\n", pos);
+            if (std::string::npos == eol) {
+                eol = headers.length();
+            }
+            auto line = headers.substr(pos, eol - pos);
+            pos = eol + 2;
+            auto colon = line.find(':');
+            if (std::string::npos == colon) {
+                continue;
+            }
+            auto name = lower(trim(line.substr(0, colon)));
+            auto value = trim(line.substr(colon + 1));
+            if ("content-disposition" == name) {
+                auto semicolon = value.find(';');
+                if (std::string::npos != semicolon) {
+                    auto params = value.substr(semicolon);
+                    pa.name = header_param(params, "name");
+                    pa.is_file = has_header_param(params, "filename");
+                    pa.filename = header_param(params, "filename");
+                }
+            } else if ("content-type" == name) {
+                pa.content_type = value;
+            }
+        }
+        if (pa.is_file) {
+            pa.path = tmp_path_gen();
+            pa.file.reset(new sl::tinydir::file_sink(pa.path));
+        }
+        parts_list.emplace_back(std::move(pa));
+    }
+
+    void append_body(const char* data, size_t len) {
+        if (0 == len) {
+            return;
+        }
+        auto& pa = parts_list.back();
+        pa.size += len;
+        if (pa.is_file) {
+            sl::io::write_all(*pa.file, {data, len});
+            return;
+        }
+        count_fields_bytes(len);
+        pa.value.append(data, len);
+    }
+
+    void count_fields_bytes(size_t len) {
+        fields_bytes += len;
+        if (fields_bytes > fields_limit) throw support::exception(TRACEMSG(
+                "Multipart form fields exceed limit (bytes): [" + sl::support::to_string(fields_limit) + "]"));
+    }
+
+    void finish_part() {
+        // closes temporary file
+        parts_list.back().file.reset();
+    }
+
+    static std::string trim(const std::string& st) {
+        auto first = st.find_first_not_of(" \t");
+        if (std::string::npos == first) return std::string();
+        auto last = st.find_last_not_of(" \t");
+        return st.substr(first, last - first + 1);
+    }
+
+    static std::string lower(std::string st) {
+        for (auto& ch : st) {
+            if (ch >= 'A' && ch <= 'Z') ch = static_cast<char>(ch - 'A' + 'a');
+        }
+        return st;
+    }
+
+    // finds 'key=value' in '; key1=value1; key2="value2"', returns position of value
+    static size_t find_header_param(const std::string& params, const std::string& key) {
+        size_t pos = 0;
+        while (pos < params.length()) {
+            auto semicolon = params.find(';', pos);
+            if (std::string::npos == semicolon) {
+                return std::string::npos;
+            }
+            auto eq = params.find('=', semicolon);
+            if (std::string::npos == eq) {
+                return std::string::npos;
+            }
+            auto name = lower(trim(params.substr(semicolon + 1, eq - semicolon - 1)));
+            auto value_start = params.find_first_not_of(" \t", eq + 1);
+            if (std::string::npos == value_start) {
+                return std::string::npos;
+            }
+            if (key == name) {
+                return value_start;
+            }
+            pos = skip_param_value(params, value_start);
+        }
+        return std::string::npos;
+    }
+
+    static size_t skip_param_value(const std::string& params, size_t start) {
+        if ('"' != params[start]) {
+            return params.find(';', start);
+        }
+        for (size_t i = start + 1; i < params.length(); i++) {
+            if ('\\' == params[i]) {
+                i += 1;
+            } else if ('"' == params[i]) {
+                return i + 1;
+            }
+        }
+        return std::string::npos;
+    }
+
+    static bool has_header_param(const std::string& params, const std::string& key) {
+        return std::string::npos != find_header_param(params, key);
+    }
+
+    static std::string header_param(const std::string& params, const std::string& key) {
+        auto start = find_header_param(params, key);
+        if (std::string::npos == start) {
+            return std::string();
+        }
+        if ('"' != params[start]) {
+            auto end = params.find(';', start);
+            return trim(params.substr(start, std::string::npos == end ? std::string::npos : end - start));
+        }
+        auto res = std::string();
+        for (size_t i = start + 1; i < params.length(); i++) {
+            char ch = params[i];
+            if ('\\' == ch && i + 1 < params.length()) {
+                i += 1;
+                res.push_back(params[i]);
+            } else if ('"' == ch) {
+                break;
+            } else {
+                res.push_back(ch);
+            }
+        }
+        return res;
+    }
+
+};
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_MULTIPART_PARSER_HPP */
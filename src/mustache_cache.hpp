@@ -24,41 +24,543 @@
 #ifndef WILTON_SERVER_MUSTACHE_CACHE_HPP
 #define WILTON_SERVER_MUSTACHE_CACHE_HPP
 
-#include <map>
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <future>
+#include <istream>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
 #include "staticlib/tinydir.hpp"
+#include "staticlib/utils.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "conf/mustache_config.hpp"
+#include "dir_watcher.hpp"
+#include "mustache_render_cache.hpp"
+#include "mustache_render_source.hpp"
+#include "mustache_template.hpp"
 
 namespace wilton {
 namespace server {
 
+/**
+ * Rendered output, outputs up to 'mustache.renderBufferMaxBytes' are
+ * rendered whole, larger ones are rendered as the stream is read
+ */
+class mustache_output {
+public:
+    // null for streamed output
+    std::shared_ptr<const std::string> body;
+    std::unique_ptr<std::istream> stream;
+};
+
+/**
+ * Templates are compiled on first use, compiled form is shared and
+ * is rendered without holding any locks; cache is split into shards
+ * by path hash, each shard is an LRU, entries count and bytes limits
+ * apply to the whole cache and are enforced by evicting from the shard
+ * of the added entry first and then from other shards in turn; files
+ * are read and compiled outside of the shard lock and concurrent misses
+ * on the same path wait for the single load in progress.
+ *
+ * Partials are loaded eagerly and are published as an immutable
+ * snapshot, renders keep the snapshot they started with. With inotify
+ * changed templates are dropped and partials are reloaded.
+ *
+ * Rendered output is optionally cached by template path and data,
+ * output is rendered into pooled buffers that are handed over to the
+ * response and are returned to the pool when the response is written.
+ * Templates from 'mustache.templateDirs' are compiled on startup.
+ */
 class mustache_cache {
-    std::mutex mutex;
-    std::map<std::string, std::string> cache;
+    using value_type = std::shared_ptr<const mustache_template>;
+
+    class entry {
+    public:
+        std::shared_future<value_type> value;
+        // distinguishes loads of the same path across invalidations
+        uint64_t id = 0;
+        bool ready = false;
+        uint64_t size = 0;
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    class shard {
+    public:
+        std::mutex mutex;
+        std::unordered_map<std::string, entry> entries;
+        // most recently used first, only ready entries
+        std::list<std::string> lru;
+        uint64_t bytes = 0;
+        uint64_t next_id = 0;
+    };
+
+    static const size_t shards_count = 16;
+
+    std::vector<std::string> partials_dirs;
+    uint64_t max_entries;
+    uint64_t max_bytes;
+    size_t render_buffer_max_bytes;
+    std::array<shard, shards_count> shards;
+    // sums over all shards
+    std::atomic<uint64_t> total_entries;
+    std::atomic<uint64_t> total_bytes;
+    // next shard to evict from when the limits are exceeded
+    std::atomic<size_t> evict_cursor;
+
+    // accessed only with atomic_load/atomic_store
+    std::shared_ptr<const mustache_partials_map> partials_snapshot;
+    std::mutex reload_mutex;
+
+    // null if disabled
+    std::unique_ptr<mustache_render_cache> rendered;
+
+    // declared last to be stopped before other members are destroyed
+    std::unique_ptr<dir_watcher> watcher;
 
 public:
-    mustache_cache() { }
+    mustache_cache(const conf::mustache_config& conf) :
+    partials_dirs(normalize_paths(conf.partialsDirs)),
+    max_entries(conf.cacheMaxEntries),
+    max_bytes(conf.cacheMaxBytes),
+    render_buffer_max_bytes(conf.renderBufferMaxBytes),
+    total_entries(0),
+    total_bytes(0),
+    evict_cursor(0),
+    partials_snapshot(load_partials(partials_dirs)),
+    rendered(conf.renderCacheMaxBytes > 0 ?
+            new mustache_render_cache(conf.renderCacheMaxBytes, conf.renderCacheTtlMillis) : nullptr) {
+        if (conf.useInotify) {
+            watcher.reset(new dir_watcher([this](const std::string& dir, const std::string& name) {
+                this->on_change(dir, name);
+            }));
+            for (auto& dir : partials_dirs) {
+                watcher->watch(dir);
+            }
+        }
+        warm_up(conf.templateDirs);
+    }
 
     mustache_cache(const mustache_cache&) = delete;
 
     mustache_cache& operator=(const mustache_cache&) = delete;
 
-    const std::string& get(const std::string& file_path) {
-        std::lock_guard<std::mutex> guard{mutex};
-        auto it = cache.find(file_path);
-        if (it != cache.end()) {
-            return it->second;
-        } else {
-            auto src = sl::tinydir::file_source(file_path);
-            auto sink = sl::io::string_sink();
-            sl::io::copy_all(src, sink);
-            auto pa = cache.insert(std::pair<std::string, std::string>(file_path, std::move(sink.get_string())));
-            auto& res = pa.first->second;
+    value_type get(const std::string& path) {
+        // keys are in the same form as paths built from watcher events
+        auto file_path = normalize_path(path);
+        auto& sh = shard_of(file_path);
+        auto promise = std::promise<value_type>();
+        auto in_flight = std::shared_future<value_type>();
+        uint64_t id = 0;
+        {
+            std::lock_guard<std::mutex> guard{sh.mutex};
+            auto it = sh.entries.find(file_path);
+            if (sh.entries.end() != it) {
+                auto& en = it->second;
+                if (en.ready) {
+                    sh.lru.splice(sh.lru.begin(), sh.lru, en.lru_pos);
+                    return en.value.get();
+                }
+                in_flight = en.value;
+            } else {
+                auto en = entry();
+                en.value = promise.get_future().share();
+                sh.next_id += 1;
+                en.id = sh.next_id;
+                id = en.id;
+                sh.entries.emplace(file_path, std::move(en));
+            }
+        }
+        if (in_flight.valid()) {
+            // other thread is loading this template
+            return in_flight.get();
+        }
+        if (nullptr != watcher.get()) {
+            // watched before reading, so changes during the load are not lost
+            watcher->watch(dir_of(file_path));
+        }
+        value_type res;
+        try {
+            res = load(file_path);
+        } catch (...) {
+            {
+                std::lock_guard<std::mutex> guard{sh.mutex};
+                auto it = sh.entries.find(file_path);
+                if (sh.entries.end() != it && id == it->second.id) {
+                    sh.entries.erase(it);
+                }
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        promise.set_value(res);
+        {
+            std::lock_guard<std::mutex> guard{sh.mutex};
+            auto it = sh.entries.find(file_path);
+            if (sh.entries.end() == it || id != it->second.id) {
+                // invalidated while loading
+                return res;
+            }
+            if (res->bytes > max_bytes) {
+                // still returned, but not kept
+                sh.entries.erase(it);
+                return res;
+            }
+            auto& en = it->second;
+            en.ready = true;
+            en.size = res->bytes;
+            sh.lru.push_front(file_path);
+            en.lru_pos = sh.lru.begin();
+            sh.bytes += en.size;
+            total_entries.fetch_add(1, std::memory_order_relaxed);
+            total_bytes.fetch_add(en.size, std::memory_order_relaxed);
+            // added entry is kept
+            while (sh.lru.size() > 1 && is_over_limits()) {
+                erase_entry(sh, sh.entries.find(sh.lru.back()));
+            }
+        }
+        evict_over_limits();
+        return res;
+    }
+
+    /**
+     * Renders template with specified data, output is taken
+     * from the render cache when it is enabled, streamed outputs
+     * are not cached
+     *
+     * @param path template path
+     * @param json template data
+     * @return rendered output
+     */
+    mustache_output render(const std::string& path, sl::json::value json) {
+        auto file_path = normalize_path(path);
+        if (nullptr == rendered.get()) {
+            auto compiled = get(file_path);
+            return render_output(std::move(compiled), std::move(json));
+        }
+        auto key = mustache_render_cache::make_key(file_path, json);
+        auto cached = rendered->get(key);
+        if (nullptr != cached.get()) {
+            auto res = mustache_output();
+            res.body = std::move(cached);
             return res;
         }
+        // taken before loading, so output of invalidated templates is not cached
+        auto gen = rendered->generation();
+        auto compiled = get(file_path);
+        auto res = render_output(std::move(compiled), std::move(json));
+        if (nullptr != res.body.get()) {
+            // pooled buffer capacity is not accounted by the cache, so it keeps an exact copy
+            rendered->put(key, std::make_shared<const std::string>(*res.body), gen);
+        }
+        return res;
+    }
+
+    /**
+     * Current partials, snapshot stays valid after reloads
+     *
+     * @return compiled partials
+     */
+    std::shared_ptr<const mustache_partials_map> partials() const {
+        return std::atomic_load(std::addressof(partials_snapshot));
+    }
+
+    /**
+     * Templates currently held in cache
+     *
+     * @return list of template paths with compiled sizes
+     */
+    sl::json::value loaded_templates() {
+        auto list = std::vector<std::pair<std::string, uint64_t>>();
+        for (auto& sh : shards) {
+            std::lock_guard<std::mutex> guard{sh.mutex};
+            for (auto& pa : sh.entries) {
+                if (pa.second.ready) {
+                    list.emplace_back(pa.first, pa.second.size);
+                }
+            }
+        }
+        std::sort(list.begin(), list.end());
+        auto res = std::vector<sl::json::value>();
+        for (auto& pa : list) {
+            res.emplace_back(sl::json::value({
+                { "path", pa.first },
+                { "bytes", pa.second }
+            }));
+        }
+        return sl::json::value(std::move(res));
+    }
+
+    /**
+     * Drops cached template
+     *
+     * @param path_prefix template path or directory prefix
+     */
+    void invalidate(const std::string& path_prefix) {
+        if (nullptr != rendered.get()) {
+            rendered->invalidate(path_prefix);
+        }
+        for (auto& sh : shards) {
+            std::lock_guard<std::mutex> guard{sh.mutex};
+            for (auto it = sh.entries.begin(); it != sh.entries.end();) {
+                auto cur = it++;
+                if (0 == cur->first.compare(0, path_prefix.length(), path_prefix)) {
+                    erase_entry(sh, cur);
+                }
+            }
+        }
+    }
+
+    /**
+     * Drops all cached templates and reloads partials,
+     * current partials are kept if they cannot be loaded
+     */
+    void reload() {
+        invalidate("");
+        reload_partials();
+    }
+
+private:
+    shard& shard_of(const std::string& file_path) {
+        return shards[std::hash<std::string>()(file_path) % shards_count];
+    }
+
+    // must be called under shard lock
+    void erase_entry(shard& sh, std::unordered_map<std::string, entry>::iterator it) {
+        if (it->second.ready) {
+            sh.bytes -= it->second.size;
+            sh.lru.erase(it->second.lru_pos);
+            total_entries.fetch_sub(1, std::memory_order_relaxed);
+            total_bytes.fetch_sub(it->second.size, std::memory_order_relaxed);
+        }
+        sh.entries.erase(it);
+    }
+
+    bool is_over_limits() const {
+        return total_entries.load(std::memory_order_relaxed) > max_entries ||
+                total_bytes.load(std::memory_order_relaxed) > max_bytes;
+    }
+
+    // takes one shard lock at a time, least recently used entry of each
+    // shard is evicted in turn until the cache fits into the limits
+    void evict_over_limits() {
+        size_t idle = 0;
+        while (idle < shards_count && is_over_limits()) {
+            auto& sh = shards[evict_cursor.fetch_add(1, std::memory_order_relaxed) % shards_count];
+            std::lock_guard<std::mutex> guard{sh.mutex};
+            if (sh.lru.empty()) {
+                idle += 1;
+                continue;
+            }
+            idle = 0;
+            erase_entry(sh, sh.entries.find(sh.lru.back()));
+        }
+    }
+
+    void reload_partials() {
+        std::lock_guard<std::mutex> guard{reload_mutex};
+        auto loaded = load_partials(partials_dirs);
+        std::atomic_store(std::addressof(partials_snapshot), std::move(loaded));
+        if (nullptr != rendered.get()) {
+            // any output may include partials
+            rendered->invalidate("");
+        }
+    }
+
+    void on_change(const std::string& dir, const std::string& name) STATICLIB_NOEXCEPT {
+        try {
+            if (dir.empty()) {
+                // events were lost
+                reload();
+                return;
+            }
+            invalidate(name.empty() ? dir_prefix(dir) : join_path(dir, name));
+            bool partials_changed = name.empty() || sl::utils::ends_with(name, mustache_ext());
+            for (auto& pd : partials_dirs) {
+                if (pd == dir && partials_changed) {
+                    if (name.empty()) {
+                        // watch was dropped, directory may have been replaced
+                        watcher->watch(pd);
+                    }
+                    reload_partials();
+                    break;
+                }
+            }
+        } catch (const std::exception&) {
+            // partial is likely being edited, previous snapshot is kept
+        }
+    }
+
+    // loads templates in parallel, first failure is reported after all workers finish
+    void warm_up(const std::vector<std::string>& dirs) {
+        auto paths = std::vector<std::string>();
+        for (auto& dir : dirs) {
+            collect_templates(dir, paths);
+        }
+        if (paths.empty()) {
+            return;
+        }
+        auto hc = static_cast<size_t>(std::max(1u, std::thread::hardware_concurrency()));
+        auto workers = std::min(paths.size(), hc);
+        std::atomic<size_t> next(0);
+        auto futures = std::vector<std::future<void>>();
+        for (size_t i = 0; i < workers; i++) {
+            futures.emplace_back(std::async(std::launch::async, [this, &paths, &next] {
+                for (;;) {
+                    auto idx = next.fetch_add(1, std::memory_order_relaxed);
+                    if (idx >= paths.size()) {
+                        return;
+                    }
+                    try {
+                        this->get(paths[idx]);
+                    } catch (const std::exception& e) {
+                        // other workers stop at their next template
+                        next.store(paths.size(), std::memory_order_relaxed);
+                        throw support::exception(TRACEMSG(e.what() +
+                                "\nError loading mustache template, path: [" + paths[idx] + "]"));
+                    }
+                }
+            }));
+        }
+        auto err = std::exception_ptr();
+        for (auto& fu : futures) {
+            try {
+                fu.get();
+            } catch (...) {
+                if (nullptr == err) {
+                    err = std::current_exception();
+                }
+            }
+        }
+        if (nullptr != err) {
+            std::rethrow_exception(err);
+        }
+    }
+
+    static void collect_templates(const std::string& dir, std::vector<std::string>& paths) {
+        for (const sl::tinydir::path& tf : sl::tinydir::list_directory(dir)) {
+            if (tf.is_directory()) {
+                collect_templates(tf.filepath(), paths);
+            } else if (tf.is_regular_file() && sl::utils::ends_with(tf.filename(), mustache_ext())) {
+                paths.push_back(tf.filepath());
+            }
+        }
+    }
+
+    mustache_output render_output(value_type compiled, sl::json::value json) {
+        auto st = sl::support::make_unique<mustache_render_state>(std::move(json), std::move(compiled),
+                partials(), render_buffer_max_bytes);
+        auto res = mustache_output();
+        if (st->render_until(render_buffer_max_bytes + 1)) {
+            res.body = st->take_body();
+        } else {
+            // rendered part is sent first, the rest is rendered as it is read
+            auto src = mustache_render_source(std::move(st), render_buffer_max_bytes);
+            res.stream = sl::io::make_source_istream_ptr(std::move(src));
+        }
+        return res;
+    }
+
+    static const std::string& mustache_ext() {
+        static const std::string ext = ".mustache";
+        return ext;
+    }
+
+    static std::string dir_of(const std::string& path) {
+        auto pos = path.rfind('/');
+        if (std::string::npos == pos) {
+            return std::string(".");
+        }
+        if (0 == pos) {
+            return std::string("/");
+        }
+        return path.substr(0, pos);
+    }
+
+    // inverse of 'dir_of'
+    static std::string join_path(const std::string& dir, const std::string& name) {
+        if ("." == dir) {
+            return name;
+        }
+        if ("/" == dir) {
+            return dir + name;
+        }
+        return dir + "/" + name;
+    }
+
+    // prefix of all keys under the directory, keys of relative
+    // paths have no common prefix, so all entries match for "."
+    static std::string dir_prefix(const std::string& dir) {
+        return join_path(dir, std::string());
+    }
+
+    // drops leading './' and trailing '/', so keys match 'join_path' results
+    static std::string normalize_path(const std::string& path) {
+        size_t start = 0;
+        while (0 == path.compare(start, 2, "./")) {
+            start = path.find_first_not_of('/', start + 2);
+            if (std::string::npos == start) {
+                return std::string(".");
+            }
+        }
+        auto end = path.find_last_not_of('/');
+        if (std::string::npos == end) {
+            return path.empty() ? std::string(".") : std::string("/");
+        }
+        if (end < start) {
+            return std::string(".");
+        }
+        return path.substr(start, end - start + 1);
+    }
+
+    static std::vector<std::string> normalize_paths(const std::vector<std::string>& paths) {
+        auto res = std::vector<std::string>();
+        for (auto& pa : paths) {
+            res.push_back(normalize_path(pa));
+        }
+        return res;
+    }
+
+    static value_type load(const std::string& file_path) {
+        return compile_mustache(read_file(file_path));
+    }
+
+    static std::string read_file(const std::string& file_path) {
+        auto src = sl::tinydir::file_source(file_path);
+        auto sink = sl::io::string_sink();
+        sl::io::copy_all(src, sink);
+        return std::move(sink.get_string());
+    }
+
+    static std::shared_ptr<const mustache_partials_map> load_partials(const std::vector<std::string>& dirs) {
+        auto res = std::make_shared<mustache_partials_map>();
+        for (const std::string& dirpath : dirs) {
+            for (const sl::tinydir::path& tf : sl::tinydir::list_directory(dirpath)) {
+                if (!sl::utils::ends_with(tf.filename(), mustache_ext())) continue;
+                auto name = std::string(tf.filename().data(), tf.filename().length() - mustache_ext().length());
+                auto val = compile_mustache(read_file(tf.filepath()));
+                auto pa = res->insert(std::make_pair(std::move(name), std::move(val)));
+                if (!pa.second) throw support::exception(TRACEMSG(
+                        "Invalid duplicate 'mustache.partialsDirs' element," +
+                        " dirpath: [" + dirpath + "], path: [" + tf.filepath() + "]"));
+            }
+        }
+        return res;
     }
 };
 
@@ -66,4 +568,3 @@ public:
 }
 
 #endif /* WILTON_SERVER_MUSTACHE_CACHE_HPP */
-
@@ -0,0 +1,258 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   mustache_render_cache.hpp
+ * Author: alex
+ *
+ * Created on October 23, 2026, 10:40 AM
+ */
+
+#ifndef WILTON_SERVER_MUSTACHE_RENDER_CACHE_HPP
+#define WILTON_SERVER_MUSTACHE_RENDER_CACHE_HPP
+
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "staticlib/json.hpp"
+
+namespace wilton {
+namespace server {
+
+/**
+ * Memory-budgeted LRU cache of rendered mustache output keyed by
+ * template path and canonical serialized data, so a hit is always
+ * rendered from equal data; entries expire after TTL,
+ * generation is bumped on every invalidation so the results rendered
+ * with the stale templates are not put back into the cache
+ */
+class mustache_render_cache {
+    using clock_type = std::chrono::steady_clock;
+
+    class entry {
+    public:
+        std::shared_ptr<const std::string> body;
+        clock_type::time_point expires_at;
+        std::list<std::string>::iterator lru_pos;
+    };
+
+    uint64_t max_bytes;
+    std::chrono::milliseconds ttl;
+
+    std::mutex mutex;
+    std::unordered_map<std::string, entry> entries;
+    // most recently used first
+    std::list<std::string> lru;
+    uint64_t bytes = 0;
+    uint64_t gen = 0;
+
+public:
+    mustache_render_cache(uint64_t max_bytes, uint32_t ttl_millis) :
+    max_bytes(max_bytes),
+    ttl(ttl_millis) { }
+
+    mustache_render_cache(const mustache_render_cache&) = delete;
+
+    mustache_render_cache& operator=(const mustache_render_cache&) = delete;
+
+    /**
+     * Creates cache key from template path and data serialized in
+     * a canonical form, objects fields are written in name order,
+     * so the key does not depend on the order of fields in data;
+     * data is written whole, user-controlled data cannot produce
+     * the key of another data
+     *
+     * @param file_path template path
+     * @param json template data
+     * @return cache key
+     */
+    static std::string make_key(const std::string& file_path, const sl::json::value& json) {
+        auto res = std::string();
+        res.append(file_path);
+        res.push_back('\0');
+        append_value(res, json);
+        return res;
+    }
+
+    /**
+     * Current generation, must be taken before rendering
+     *
+     * @return generation
+     */
+    uint64_t generation() {
+        std::lock_guard<std::mutex> guard{mutex};
+        return gen;
+    }
+
+    /**
+     * Looks up rendered output
+     *
+     * @param key cache key
+     * @return rendered output or null
+     */
+    std::shared_ptr<const std::string> get(const std::string& key) {
+        std::lock_guard<std::mutex> guard{mutex};
+        auto it = entries.find(key);
+        if (entries.end() == it) {
+            return std::shared_ptr<const std::string>();
+        }
+        if (clock_type::now() >= it->second.expires_at) {
+            erase_entry(it);
+            return std::shared_ptr<const std::string>();
+        }
+        lru.splice(lru.begin(), lru, it->second.lru_pos);
+        return it->second.body;
+    }
+
+    /**
+     * Adds rendered output evicting least recently used entries,
+     * output is dropped if cache was invalidated after 'generation'
+     * call
+     *
+     * @param key cache key
+     * @param body rendered output
+     * @param rendered_gen generation taken before rendering
+     */
+    void put(const std::string& key, std::shared_ptr<const std::string> body, uint64_t rendered_gen) {
+        uint64_t size = entry_bytes(key, *body);
+        if (size > max_bytes) {
+            return;
+        }
+        std::lock_guard<std::mutex> guard{mutex};
+        if (rendered_gen != gen) {
+            return;
+        }
+        auto existing = entries.find(key);
+        if (entries.end() != existing) {
+            erase_entry(existing);
+        }
+        while (bytes + size > max_bytes && !lru.empty()) {
+            erase_entry(entries.find(lru.back()));
+        }
+        bytes += size;
+        lru.push_front(key);
+        auto en = entry();
+        en.body = std::move(body);
+        en.expires_at = clock_type::now() + ttl;
+        en.lru_pos = lru.begin();
+        entries.emplace(key, std::move(en));
+    }
+
+    /**
+     * Drops rendered output of the templates
+     *
+     * @param path_prefix template path or directory prefix,
+     *        empty prefix drops all entries
+     */
+    void invalidate(const std::string& path_prefix) {
+        std::lock_guard<std::mutex> guard{mutex};
+        gen += 1;
+        for (auto it = entries.begin(); it != entries.end();) {
+            auto cur = it++;
+            if (0 == cur->first.compare(0, path_prefix.length(), path_prefix)) {
+                erase_entry(cur);
+            }
+        }
+    }
+
+private:
+    // must be called under lock
+    void erase_entry(std::unordered_map<std::string, entry>::iterator it) {
+        bytes -= entry_bytes(it->first, *it->second.body);
+        lru.erase(it->second.lru_pos);
+        entries.erase(it);
+    }
+
+    // key is kept in the map and in the LRU list
+    static uint64_t entry_bytes(const std::string& key, const std::string& body) {
+        return static_cast<uint64_t>(key.length()) * 2 + body.length();
+    }
+
+    static void append_bytes(std::string& out, const char* data, size_t len) {
+        out.append(data, len);
+    }
+
+    // length-prefixed, so adjacent strings cannot be shifted into each other
+    static void append_string(std::string& out, const std::string& str) {
+        uint64_t len = str.length();
+        append_bytes(out, reinterpret_cast<const char*>(std::addressof(len)), sizeof(len));
+        append_bytes(out, str.data(), str.length());
+    }
+
+    static void append_value(std::string& out, const sl::json::value& val) {
+        char tag = static_cast<char>(val.json_type());
+        append_bytes(out, std::addressof(tag), 1);
+        switch (val.json_type()) {
+        case sl::json::type::object: {
+            auto fields = std::vector<const sl::json::field*>();
+            for (const sl::json::field& fi : val.as_object()) {
+                fields.push_back(std::addressof(fi));
+            }
+            std::sort(fields.begin(), fields.end(), [](const sl::json::field* a, const sl::json::field* b) {
+                return a->name() < b->name();
+            });
+            uint64_t count = fields.size();
+            append_bytes(out, reinterpret_cast<const char*>(std::addressof(count)), sizeof(count));
+            for (auto fi : fields) {
+                append_string(out, fi->name());
+                append_value(out, fi->val());
+            }
+            break;
+        }
+        case sl::json::type::array: {
+            uint64_t count = val.as_array().size();
+            append_bytes(out, reinterpret_cast<const char*>(std::addressof(count)), sizeof(count));
+            for (const sl::json::value& el : val.as_array()) {
+                append_value(out, el);
+            }
+            break;
+        }
+        case sl::json::type::string:
+            append_string(out, val.as_string());
+            break;
+        case sl::json::type::integer: {
+            int64_t num = val.as_int64();
+            append_bytes(out, reinterpret_cast<const char*>(std::addressof(num)), sizeof(num));
+            break;
+        }
+        case sl::json::type::real: {
+            double num = val.as_float();
+            append_bytes(out, reinterpret_cast<const char*>(std::addressof(num)), sizeof(num));
+            break;
+        }
+        case sl::json::type::boolean: {
+            char flag = val.as_bool() ? 1 : 0;
+            append_bytes(out, std::addressof(flag), 1);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+};
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_MUSTACHE_RENDER_CACHE_HPP */
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   mustache_render_source.hpp
+ * Author: alex
+ *
+ * Created on October 27, 2026, 4:20 PM
+ */
+
+#ifndef WILTON_SERVER_MUSTACHE_RENDER_SOURCE_HPP
+#define WILTON_SERVER_MUSTACHE_RENDER_SOURCE_HPP
+
+#include <cstring>
+#include <algorithm>
+#include <ios>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "staticlib/config.hpp"
+#include "staticlib/io.hpp"
+#include "staticlib/json.hpp"
+
+#include "mustache_template.hpp"
+#include "payload_buffer_pool.hpp"
+
+namespace wilton {
+namespace server {
+
+/**
+ * Wraps pooled buffer into a shared body, buffer is returned
+ * to the pool of the thread that drops the last reference
+ *
+ * @param buffer buffer acquired from 'payload_buffer_pool'
+ * @return shared body
+ */
+inline std::shared_ptr<const std::string> make_pooled_body(std::string&& buffer) {
+    return std::shared_ptr<const std::string>(new std::string(std::move(buffer)), [](const std::string* body) {
+        auto owned = std::unique_ptr<std::string>(const_cast<std::string*>(body));
+        payload_buffer_pool::local().release(std::move(*owned));
+    });
+}
+
+/**
+ * Owns everything the renderer points to, so rendering can be
+ * suspended and resumed on another thread; output is appended
+ * to a pooled buffer
+ */
+class mustache_render_state {
+    sl::json::value json;
+    std::shared_ptr<const mustache_template> tmpl;
+    std::shared_ptr<const mustache_partials_map> parts;
+    std::string buffer;
+    mustache_renderer renderer;
+
+public:
+    mustache_render_state(sl::json::value json, std::shared_ptr<const mustache_template> tmpl,
+            std::shared_ptr<const mustache_partials_map> parts, size_t buffer_size) :
+    json(std::move(json)),
+    tmpl(std::move(tmpl)),
+    parts(std::move(parts)),
+    buffer(payload_buffer_pool::local().acquire(buffer_size)),
+    renderer(*this->parts, this->buffer) {
+        renderer.start(*this->tmpl, this->json);
+    }
+
+    mustache_render_state(const mustache_render_state&) = delete;
+
+    mustache_render_state& operator=(const mustache_render_state&) = delete;
+
+    ~mustache_render_state() STATICLIB_NOEXCEPT {
+        payload_buffer_pool::local().release(std::move(buffer));
+    }
+
+    /**
+     * Renders next part of the output into the buffer
+     *
+     * @param out_len buffer length to stop at
+     * @return true if the whole template is rendered
+     */
+    bool render_until(size_t out_len) {
+        return renderer.render_until(out_len);
+    }
+
+    std::string& output() {
+        return buffer;
+    }
+
+    /**
+     * Takes rendered output without copying it
+     *
+     * @return body that returns the buffer to the pool when dropped
+     */
+    std::shared_ptr<const std::string> take_body() {
+        return make_pooled_body(std::move(buffer));
+    }
+
+};
+
+/**
+ * Source that renders the template incrementally, output is produced
+ * in parts of about the specified size as it is read, the part
+ * already in the buffer is read first
+ */
+class mustache_render_source {
+    std::unique_ptr<mustache_render_state> state;
+    size_t part_len;
+    size_t offset = 0;
+    bool finished = false;
+
+public:
+    mustache_render_source(std::unique_ptr<mustache_render_state> state, size_t part_len) :
+    state(std::move(state)),
+    part_len(std::max(part_len, static_cast<size_t>(1))) { }
+
+    mustache_render_source(const mustache_render_source&) = delete;
+
+    mustache_render_source& operator=(const mustache_render_source&) = delete;
+
+    mustache_render_source(mustache_render_source&& other) :
+    state(std::move(other.state)),
+    part_len(other.part_len),
+    offset(other.offset),
+    finished(other.finished) { }
+
+    mustache_render_source& operator=(mustache_render_source&&) = delete;
+
+    std::streamsize read(sl::io::span<char> span) {
+        auto& buf = state->output();
+        if (offset == buf.length()) {
+            if (finished) {
+                return std::char_traits<char>::eof();
+            }
+            buf.clear();
+            offset = 0;
+            finished = state->render_until(part_len);
+            if (buf.empty()) {
+                return std::char_traits<char>::eof();
+            }
+        }
+        auto len = std::min(span.size(), buf.length() - offset);
+        std::memcpy(span.data(), buf.data() + offset, len);
+        offset += len;
+        return static_cast<std::streamsize>(len);
+    }
+
+};
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_MUSTACHE_RENDER_SOURCE_HPP */
@@ -0,0 +1,493 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   mustache_template.hpp
+ * Author: alex
+ *
+ * Created on October 21, 2026, 2:45 PM
+ */
+
+#ifndef WILTON_SERVER_MUSTACHE_TEMPLATE_HPP
+#define WILTON_SERVER_MUSTACHE_TEMPLATE_HPP
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "staticlib/json.hpp"
+#include "staticlib/support.hpp"
+
+#include "wilton/support/exception.hpp"
+
+#include "html_escape.hpp"
+
+namespace wilton {
+namespace server {
+
+enum class mustache_op_kind {
+    text, escaped, unescaped, section, inverted, partial
+};
+
+/**
+ * Single instruction of the compiled template, section bodies
+ * are stored inline right after the section instruction
+ */
+class mustache_op {
+public:
+    mustache_op_kind kind;
+    // literal text or partial name
+    std::string text;
+    // dotted name split into parts, empty for implicit iterator
+    std::vector<std::string> path;
+    // for sections: index of the first instruction after the body
+    size_t end = 0;
+
+    mustache_op(mustache_op_kind kind, std::string text) :
+    kind(kind),
+    text(std::move(text)) { }
+};
+
+/**
+ * Immutable tokenized template, compiled once and then rendered
+ * concurrently from any thread
+ */
+class mustache_template {
+public:
+    std::vector<mustache_op> ops;
+    // approximate memory footprint
+    uint64_t bytes = 0;
+};
+
+using mustache_partials_map = std::map<std::string, std::shared_ptr<const mustache_template>>;
+
+namespace { // anonymous
+
+// guards against recursive partials
+const size_t mustache_max_depth = 64;
+
+bool mustache_is_blank(const std::string& text, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        if (' ' != text[i] && '\t' != text[i] && '\r' != text[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string mustache_trim(const std::string& str) {
+    auto first = str.find_first_not_of(" \t\r\n");
+    if (std::string::npos == first) {
+        return std::string();
+    }
+    auto last = str.find_last_not_of(" \t\r\n");
+    return str.substr(first, last - first + 1);
+}
+
+std::vector<std::string> mustache_split_path(const std::string& name) {
+    auto res = std::vector<std::string>();
+    if ("." == name) {
+        return res;
+    }
+    size_t pos = 0;
+    for (;;) {
+        auto dot = name.find('.', pos);
+        if (std::string::npos == dot) {
+            res.emplace_back(name.substr(pos));
+            return res;
+        }
+        res.emplace_back(name.substr(pos, dot - pos));
+        pos = dot + 1;
+    }
+}
+
+} // namespace
+
+/**
+ * Compiles mustache template, supports variables, sections, inverted
+ * sections, comments, partials and delimiter changes; tags on
+ * otherwise blank lines are removed together with their lines
+ *
+ * @param text template text
+ * @return compiled template
+ */
+inline std::shared_ptr<const mustache_template> compile_mustache(const std::string& text) {
+    auto res = std::make_shared<mustache_template>();
+    auto& ops = res->ops;
+    auto open = std::string("{{");
+    auto close = std::string("}}");
+    // indices of open sections and their names
+    auto sections = std::vector<std::pair<size_t, std::string>>();
+    size_t pos = 0;
+    auto add_text = [&ops, &text](size_t begin, size_t end) {
+        if (end > begin) {
+            ops.emplace_back(mustache_op_kind::text, text.substr(begin, end - begin));
+        }
+    };
+    for (;;) {
+        auto tag_start = text.find(open, pos);
+        if (std::string::npos == tag_start) {
+            add_text(pos, text.length());
+            break;
+        }
+        size_t content_start = tag_start + open.length();
+        auto tag_close = close;
+        // triple mustache is recognized with any delimiters, e.g. '<%{name}%>'
+        if (content_start < text.length() && '{' == text[content_start]) {
+            tag_close = "}" + close;
+        }
+        auto content_end = text.find(tag_close, content_start);
+        if (std::string::npos == content_end) throw support::exception(TRACEMSG(
+                "Invalid mustache template, unclosed tag at position: [" + sl::support::to_string(tag_start) + "]"));
+        size_t tag_end = content_end + tag_close.length();
+        auto content = text.substr(content_start, content_end - content_start);
+        char sigil = content.empty() ? '\0' : content[0];
+        bool standalone_capable = '#' == sigil || '^' == sigil || '/' == sigil ||
+                '!' == sigil || '>' == sigil || '=' == sigil;
+        // whole line is dropped if the tag is the only thing on it
+        size_t text_end = tag_start;
+        size_t next_pos = tag_end;
+        if (standalone_capable) {
+            auto nl_before = 0 == tag_start ? std::string::npos : text.rfind('\n', tag_start - 1);
+            size_t line_start = std::string::npos == nl_before ? 0 : nl_before + 1;
+            auto nl_after = text.find('\n', tag_end);
+            size_t line_end = std::string::npos == nl_after ? text.length() : nl_after;
+            if (line_start >= pos && mustache_is_blank(text, line_start, tag_start) &&
+                    mustache_is_blank(text, tag_end, line_end)) {
+                text_end = line_start;
+                next_pos = std::string::npos == nl_after ? text.length() : nl_after + 1;
+            }
+        }
+        add_text(pos, text_end);
+        pos = next_pos;
+        switch (sigil) {
+        case '!':
+            break;
+        case '=': {
+            auto delims = mustache_trim(content.substr(1, content.length() > 1 ? content.length() - 2 : 0));
+            auto space = delims.find_first_of(" \t");
+            if (content.length() < 2 || '=' != content.back() || std::string::npos == space) {
+                throw support::exception(TRACEMSG(
+                        "Invalid mustache delimiters specified: [" + content + "]"));
+            }
+            open = delims.substr(0, space);
+            close = mustache_trim(delims.substr(space));
+            break;
+        }
+        case '#':
+        case '^': {
+            auto name = mustache_trim(content.substr(1));
+            auto kind = '#' == sigil ? mustache_op_kind::section : mustache_op_kind::inverted;
+            ops.emplace_back(kind, std::string());
+            ops.back().path = mustache_split_path(name);
+            sections.emplace_back(ops.size() - 1, std::move(name));
+            break;
+        }
+        case '/': {
+            auto name = mustache_trim(content.substr(1));
+            if (sections.empty() || sections.back().second != name) throw support::exception(TRACEMSG(
+                    "Invalid mustache template, unexpected closing tag: [" + name + "]"));
+            ops[sections.back().first].end = ops.size();
+            sections.pop_back();
+            break;
+        }
+        case '>':
+            ops.emplace_back(mustache_op_kind::partial, mustache_trim(content.substr(1)));
+            break;
+        case '{':
+        case '&':
+            ops.emplace_back(mustache_op_kind::unescaped, std::string());
+            ops.back().path = mustache_split_path(mustache_trim(content.substr(1)));
+            break;
+        default:
+            ops.emplace_back(mustache_op_kind::escaped, std::string());
+            ops.back().path = mustache_split_path(mustache_trim(content));
+        }
+    }
+    if (!sections.empty()) throw support::exception(TRACEMSG(
+            "Invalid mustache template, unclosed section: [" + sections.back().second + "]"));
+    res->bytes = sizeof(mustache_template);
+    for (auto& op : ops) {
+        res->bytes += sizeof(mustache_op) + op.text.length();
+        for (auto& part : op.path) {
+            res->bytes += sizeof(std::string) + part.length();
+        }
+    }
+    return res;
+}
+
+/**
+ * Walks compiled template appending output to the specified string,
+ * walk state is kept in explicit frames, so rendering can be suspended
+ * when enough output is produced and resumed later
+ */
+class mustache_renderer {
+    // range of ops being rendered, sections and partials add frames
+    struct frame {
+        const mustache_template* tmpl;
+        size_t begin;
+        size_t pos;
+        size_t end;
+        // elements of array section, null for other frames
+        const std::vector<sl::json::value>* items;
+        size_t item_idx;
+        bool pushes_context;
+        bool is_partial;
+    };
+
+    const mustache_partials_map& partials;
+    std::string& out;
+    std::vector<const sl::json::value*> stack;
+    std::vector<frame> frames;
+    size_t depth = 0;
+
+public:
+    mustache_renderer(const mustache_partials_map& partials, std::string& out) :
+    partials(partials),
+    out(out) { }
+
+    mustache_renderer(const mustache_renderer&) = delete;
+
+    mustache_renderer& operator=(const mustache_renderer&) = delete;
+
+    void render(const mustache_template& tmpl, const sl::json::value& json) {
+        start(tmpl, json);
+        render_until(std::numeric_limits<size_t>::max());
+    }
+
+    /**
+     * Prepares rendering of the template, output is produced
+     * by 'render_until' calls; template and data must stay alive
+     * until rendering is finished
+     *
+     * @param tmpl compiled template
+     * @param json template values
+     */
+    void start(const mustache_template& tmpl, const sl::json::value& json) {
+        stack.clear();
+        frames.clear();
+        depth = 0;
+        stack.push_back(std::addressof(json));
+        push_frame(tmpl, 0, tmpl.ops.size(), nullptr, false, false);
+    }
+
+    /**
+     * Renders until the output reaches specified length, output
+     * may exceed it by the size of a single tag or text block
+     *
+     * @param out_len output length to stop at
+     * @return true if the whole template is rendered
+     */
+    bool render_until(size_t out_len) {
+        while (!frames.empty() && out.length() < out_len) {
+            step();
+        }
+        return frames.empty();
+    }
+
+private:
+    void push_frame(const mustache_template& tmpl, size_t begin, size_t end,
+            const std::vector<sl::json::value>* items, bool pushes_context, bool is_partial) {
+        auto fr = frame();
+        fr.tmpl = std::addressof(tmpl);
+        fr.begin = begin;
+        fr.pos = begin;
+        fr.end = end;
+        fr.items = items;
+        fr.item_idx = 0;
+        fr.pushes_context = pushes_context;
+        fr.is_partial = is_partial;
+        frames.push_back(fr);
+    }
+
+    // 'fr' reference is not used after a frame is pushed
+    void step() {
+        auto& fr = frames.back();
+        if (fr.pos >= fr.end) {
+            finish_frame();
+            return;
+        }
+        auto& tmpl = *fr.tmpl;
+        size_t idx = fr.pos;
+        auto& op = tmpl.ops[idx];
+        switch (op.kind) {
+        case mustache_op_kind::text:
+            out.append(op.text);
+            fr.pos += 1;
+            break;
+        case mustache_op_kind::escaped:
+            append_escaped(lookup(op.path));
+            fr.pos += 1;
+            break;
+        case mustache_op_kind::unescaped:
+            append_value(lookup(op.path));
+            fr.pos += 1;
+            break;
+        case mustache_op_kind::section:
+            fr.pos = op.end;
+            start_section(tmpl, op, idx);
+            break;
+        case mustache_op_kind::inverted:
+            fr.pos = op.end;
+            if (is_falsy(lookup(op.path))) {
+                push_frame(tmpl, idx + 1, op.end, nullptr, false, false);
+            }
+            break;
+        case mustache_op_kind::partial:
+            fr.pos += 1;
+            start_partial(op.text);
+            break;
+        }
+    }
+
+    void finish_frame() {
+        auto& fr = frames.back();
+        if (nullptr != fr.items && fr.item_idx + 1 < fr.items->size()) {
+            // next element of array section
+            fr.item_idx += 1;
+            stack.back() = std::addressof((*fr.items)[fr.item_idx]);
+            fr.pos = fr.begin;
+            return;
+        }
+        if (fr.pushes_context) {
+            stack.pop_back();
+        }
+        if (fr.is_partial) {
+            depth -= 1;
+        }
+        frames.pop_back();
+    }
+
+    void start_section(const mustache_template& tmpl, const mustache_op& op, size_t idx) {
+        auto val = lookup(op.path);
+        if (is_falsy(val)) {
+            return;
+        }
+        if (sl::json::type::array == val->json_type()) {
+            // not empty, empty arrays are falsy
+            auto& items = val->as_array();
+            stack.push_back(std::addressof(items.front()));
+            push_frame(tmpl, idx + 1, op.end, std::addressof(items), true, false);
+        } else {
+            stack.push_back(val);
+            push_frame(tmpl, idx + 1, op.end, nullptr, true, false);
+        }
+    }
+
+    void start_partial(const std::string& name) {
+        auto it = partials.find(name);
+        if (partials.end() == it) {
+            return;
+        }
+        if (depth >= mustache_max_depth) throw support::exception(TRACEMSG(
+                "Mustache partials nesting is too deep, partial: [" + name + "]"));
+        depth += 1;
+        push_frame(*it->second, 0, it->second->ops.size(), nullptr, false, true);
+    }
+
+    const sl::json::value* lookup(const std::vector<std::string>& path) {
+        if (path.empty()) {
+            return stack.back();
+        }
+        const sl::json::value* res = nullptr;
+        for (auto it = stack.rbegin(); it != stack.rend(); ++it) {
+            res = find_field(**it, path.front());
+            if (nullptr != res) {
+                break;
+            }
+        }
+        // dotted names are resolved only from the first part match
+        for (size_t i = 1; i < path.size() && nullptr != res; i++) {
+            res = find_field(*res, path[i]);
+        }
+        return res;
+    }
+
+    static const sl::json::value* find_field(const sl::json::value& val, const std::string& name) {
+        if (sl::json::type::object != val.json_type()) {
+            return nullptr;
+        }
+        for (auto& fi : val.as_object()) {
+            if (name == fi.name()) {
+                return std::addressof(fi.val());
+            }
+        }
+        return nullptr;
+    }
+
+    static bool is_falsy(const sl::json::value* val) {
+        if (nullptr == val) {
+            return true;
+        }
+        switch (val->json_type()) {
+        case sl::json::type::nullt: return true;
+        case sl::json::type::boolean: return !val->as_bool();
+        case sl::json::type::integer: return 0 == val->as_int64();
+        case sl::json::type::real: return 0 == val->as_float();
+        case sl::json::type::string: return val->as_string().empty();
+        case sl::json::type::array: return val->as_array().empty();
+        default: return false;
+        }
+    }
+
+    void append_value(const sl::json::value* val) {
+        if (nullptr == val) {
+            return;
+        }
+        switch (val->json_type()) {
+        case sl::json::type::string: out.append(val->as_string()); break;
+        case sl::json::type::integer: out.append(sl::support::to_string(val->as_int64())); break;
+        case sl::json::type::real: out.append(sl::support::to_string(val->as_float())); break;
+        case sl::json::type::boolean: out.append(val->as_bool() ? "true" : "false"); break;
+        default: break;
+        }
+    }
+
+    void append_escaped(const sl::json::value* val) {
+        if (nullptr == val || sl::json::type::string != val->json_type()) {
+            append_value(val);
+            return;
+        }
+        auto& str = val->as_string();
+        append_html_escaped(out, str.data(), str.length());
+    }
+
+};
+
+/**
+ * Renders compiled template
+ *
+ * @param tmpl compiled template
+ * @param json template values
+ * @param partials compiled partials
+ * @return rendered text
+ */
+inline std::string render_mustache(const mustache_template& tmpl, const sl::json::value& json,
+        const mustache_partials_map& partials) {
+    auto res = std::string();
+    mustache_renderer renderer(partials, res);
+    renderer.render(tmpl, json);
+    return res;
+}
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_MUSTACHE_TEMPLATE_HPP */
@@ -0,0 +1,256 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   native_file.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 10:12 AM
+ */
+
+#ifndef WILTON_SERVER_NATIVE_FILE_HPP
+#define WILTON_SERVER_NATIVE_FILE_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <ios>
+#include <memory>
+#include <string>
+
+#ifndef STATICLIB_WINDOWS
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#else // STATICLIB_WINDOWS
+#include <sys/stat.h>
+#include <sys/types.h>
+#endif // !STATICLIB_WINDOWS
+
+#include "staticlib/config.hpp"
+#include "staticlib/io.hpp"
+#include "staticlib/utils.hpp"
+
+namespace wilton {
+namespace server {
+
+/**
+ * File metadata obtained with 'stat' without opening the file
+ */
+class native_file_info {
+public:
+    bool exists = false;
+    bool regular = false;
+    uint64_t size = 0;
+    int64_t mtime = 0;
+    uint64_t inode = 0;
+};
+
+/**
+ * Read-only OS file descriptor with the metadata obtained from 'fstat'
+ * right after opening, reads are positional so single instance
+ * can be shared between IO threads
+ */
+class native_file {
+    int fd;
+    uint64_t file_size;
+    int64_t mtime_secs;
+    uint64_t inode_num;
+    bool regular;
+
+public:
+    native_file(int fd, uint64_t file_size, int64_t mtime_secs, uint64_t inode_num, bool regular) :
+    fd(fd),
+    file_size(file_size),
+    mtime_secs(mtime_secs),
+    inode_num(inode_num),
+    regular(regular) { }
+
+    native_file(const native_file&) = delete;
+
+    native_file& operator=(const native_file&) = delete;
+
+    ~native_file() STATICLIB_NOEXCEPT {
+#ifndef STATICLIB_WINDOWS
+        if (-1 != fd) {
+            ::close(fd);
+        }
+#endif // !STATICLIB_WINDOWS
+    }
+
+    /**
+     * Opens specified path for reading
+     *
+     * @param path file path
+     * @return opened file or null if file cannot be opened or is a directory
+     */
+    static std::shared_ptr<native_file> open(const std::string& path) {
+#ifndef STATICLIB_WINDOWS
+        int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (-1 == fd) {
+            return std::shared_ptr<native_file>();
+        }
+        struct stat st;
+        if (0 != ::fstat(fd, std::addressof(st)) || S_ISDIR(st.st_mode)) {
+            ::close(fd);
+            return std::shared_ptr<native_file>();
+        }
+        return std::make_shared<native_file>(fd, static_cast<uint64_t>(st.st_size),
+                static_cast<int64_t>(st.st_mtime), static_cast<uint64_t>(st.st_ino),
+                S_ISREG(st.st_mode));
+#else
+        (void) path;
+        return std::shared_ptr<native_file>();
+#endif // !STATICLIB_WINDOWS
+    }
+
+    /**
+     * Reads file metadata, directories are reported as non-existing;
+     * available on all platforms, inode is not reported on Windows
+     *
+     * @param path file path
+     * @return file metadata
+     */
+    static native_file_info stat(const std::string& path) {
+        auto res = native_file_info();
+#ifndef STATICLIB_WINDOWS
+        struct stat st;
+        if (0 == ::stat(path.c_str(), std::addressof(st)) && !S_ISDIR(st.st_mode)) {
+            res.exists = true;
+            res.regular = S_ISREG(st.st_mode);
+            res.size = static_cast<uint64_t>(st.st_size);
+            res.mtime = static_cast<int64_t>(st.st_mtime);
+            res.inode = static_cast<uint64_t>(st.st_ino);
+        }
+#else
+        struct _stat64 st;
+        if (0 == ::_wstat64(sl::utils::widen(path).c_str(), std::addressof(st)) && 0 == (st.st_mode & _S_IFDIR)) {
+            res.exists = true;
+            res.regular = 0 != (st.st_mode & _S_IFREG);
+            res.size = static_cast<uint64_t>(st.st_size);
+            res.mtime = static_cast<int64_t>(st.st_mtime);
+        }
+#endif // !STATICLIB_WINDOWS
+        return res;
+    }
+
+    /**
+     * Native descriptors are not used on Windows, callers
+     * must fall back to 'sl::tinydir::file_source' there
+     *
+     * @return whether 'open' can be used on this platform
+     */
+    static bool is_supported() {
+#ifndef STATICLIB_WINDOWS
+        return true;
+#else
+        return false;
+#endif // !STATICLIB_WINDOWS
+    }
+
+    int handle() const {
+        return fd;
+    }
+
+    uint64_t size() const {
+        return file_size;
+    }
+
+    int64_t mtime() const {
+        return mtime_secs;
+    }
+
+    uint64_t inode() const {
+        return inode_num;
+    }
+
+    bool is_regular_file() const {
+        return regular;
+    }
+
+    std::streamsize read_at(sl::io::span<char> span, uint64_t offset) {
+#ifndef STATICLIB_WINDOWS
+        for (;;) {
+            auto res = ::pread(fd, span.data(), span.size(), static_cast<off_t>(offset));
+            if (res >= 0) {
+                return static_cast<std::streamsize>(res);
+            }
+            if (EINTR != errno) {
+                return -1;
+            }
+        }
+#else
+        (void) span;
+        (void) offset;
+        return -1;
+#endif // !STATICLIB_WINDOWS
+    }
+};
+
+/**
+ * Source over a byte range of a shared 'native_file'
+ */
+class native_file_source {
+    std::shared_ptr<native_file> file;
+    uint64_t offset;
+    uint64_t remaining;
+
+public:
+    native_file_source(std::shared_ptr<native_file> file, uint64_t offset, uint64_t length) :
+    file(std::move(file)),
+    offset(offset),
+    remaining(length) { }
+
+    native_file_source(const native_file_source&) = delete;
+
+    native_file_source& operator=(const native_file_source&) = delete;
+
+    native_file_source(native_file_source&& other) :
+    file(std::move(other.file)),
+    offset(other.offset),
+    remaining(other.remaining) {
+        other.remaining = 0;
+    }
+
+    native_file_source& operator=(native_file_source&& other) {
+        this->file = std::move(other.file);
+        this->offset = other.offset;
+        this->remaining = other.remaining;
+        other.remaining = 0;
+        return *this;
+    }
+
+    std::streamsize read(sl::io::span<char> span) {
+        if (0 == remaining) {
+            return std::char_traits<char>::eof();
+        }
+        size_t len = span.size() < remaining ? span.size() : static_cast<size_t>(remaining);
+        auto res = file->read_at({span.data(), len}, offset);
+        if (res <= 0) {
+            // truncated concurrently or IO error
+            remaining = 0;
+            return std::char_traits<char>::eof();
+        }
+        offset += static_cast<uint64_t>(res);
+        remaining -= static_cast<uint64_t>(res);
+        return res;
+    }
+};
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_NATIVE_FILE_HPP */
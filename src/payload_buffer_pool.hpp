@@ -0,0 +1,143 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   payload_buffer_pool.hpp
+ * Author: alex
+ *
+ * Created on October 24, 2026, 2:15 PM
+ */
+
+#ifndef WILTON_SERVER_PAYLOAD_BUFFER_POOL_HPP
+#define WILTON_SERVER_PAYLOAD_BUFFER_POOL_HPP
+
+#include <cstdint>
+#include <array>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace wilton {
+namespace server {
+
+/**
+ * Per-thread pool of request body buffers, buffers are grouped
+ * in power-of-two size classes from 4KB to 1MB; buffer may be released
+ * on a thread other than the one it was acquired on, larger buffers and
+ * buffers over the per-class limit are freed
+ */
+class payload_buffer_pool {
+    static const size_t min_class_bytes = 4096;
+    static const size_t classes_count = 9;
+    static const size_t max_per_class = 2;
+
+    std::array<std::vector<std::string>, classes_count> free_lists;
+
+public:
+    payload_buffer_pool() { }
+
+    payload_buffer_pool(const payload_buffer_pool&) = delete;
+
+    payload_buffer_pool& operator=(const payload_buffer_pool&) = delete;
+
+    /**
+     * Pool of the current thread
+     *
+     * @return thread-local pool
+     */
+    static payload_buffer_pool& local() {
+        static thread_local payload_buffer_pool pool;
+        return pool;
+    }
+
+    /**
+     * Returns empty buffer with capacity of at least specified size
+     *
+     * @param size expected data size
+     * @return empty buffer
+     */
+    std::string acquire(size_t size) {
+        size_t idx = class_for_size(size);
+        if (idx >= classes_count) {
+            auto res = std::string();
+            res.reserve(size);
+            return res;
+        }
+        auto& list = free_lists[idx];
+        if (!list.empty()) {
+            auto res = std::move(list.back());
+            list.pop_back();
+            return res;
+        }
+        auto res = std::string();
+        res.reserve(class_bytes(idx));
+        return res;
+    }
+
+    /**
+     * Size of the largest pooled buffer
+     *
+     * @return largest class size
+     */
+    static size_t max_pooled_bytes() {
+        return class_bytes(classes_count - 1);
+    }
+
+    /**
+     * Takes buffer back into the pool
+     *
+     * @param buf buffer, its contents are discarded
+     */
+    void release(std::string&& buf) {
+        auto cap = buf.capacity();
+        if (cap < min_class_bytes) {
+            return;
+        }
+        // largest class that fits into the capacity
+        size_t idx = 0;
+        while (idx + 1 < classes_count && class_bytes(idx + 1) <= cap) {
+            idx += 1;
+        }
+        if (cap >= class_bytes(idx) * 2) {
+            return;
+        }
+        auto& list = free_lists[idx];
+        if (list.size() < max_per_class) {
+            buf.clear();
+            list.push_back(std::move(buf));
+        }
+    }
+
+private:
+    static size_t class_bytes(size_t idx) {
+        return min_class_bytes << idx;
+    }
+
+    // smallest class that holds specified size, 'classes_count' if none
+    static size_t class_for_size(size_t size) {
+        size_t idx = 0;
+        while (idx < classes_count && class_bytes(idx) < size) {
+            idx += 1;
+        }
+        return idx;
+    }
+
+};
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_PAYLOAD_BUFFER_POOL_HPP */
@@ -34,7 +34,6 @@
 #include "staticlib/io.hpp"
 #include "staticlib/pion.hpp"
 #include "staticlib/pion/http_parser.hpp"
-#include "staticlib/mustache.hpp"
 #include "staticlib/pimpl/forward_macros.hpp"
 #include "staticlib/json.hpp"
 #include "staticlib/tinydir.hpp"
@@ -46,6 +45,9 @@
 #include "conf/header.hpp"
 #include "conf/response_metadata.hpp"
 #include "conf/request_metadata.hpp"
+#include "native_file.hpp"
+#include "response_file_sender.hpp"
+#include "response_memory_sender.hpp"
 #include "response_stream_sender.hpp"
 #include "request_payload_handler.hpp"
 
@@ -54,7 +56,7 @@ namespace server {
 
 namespace { // anonymous
 
-using partmap_type = const std::map<std::string, std::string>&;
+using io_pool_type = std::shared_ptr<blocking_io_pool>;
 
 const std::unordered_set<std::string> HEADERS_DISCARD_DUPLICATES{
     "age", "authorization", "content-length", "content-type", "etag", "expires",
@@ -77,7 +79,7 @@ class request::impl : public sl::pimpl::object::impl {
     sl::pion::http_request_ptr req;
     sl::pion::response_writer_ptr resp;
     sl::support::observer_ptr<mustache_cache> mustache_templates;
-    sl::support::observer_ptr<const std::map<std::string, std::string>> mustache_partials;
+    std::shared_ptr<blocking_io_pool> io_pool;
 
     // ws state
     sl::pion::websocket_ptr ws;
@@ -87,12 +89,12 @@ public:
 
     impl(void* /* sl::pion::http_request_ptr&& */ req, void* /* sl::pion::response_writer_ptr&& */ resp,
             mustache_cache& mustache_templates,
-            const std::map<std::string, std::string>& mustache_partials) :
+            std::shared_ptr<blocking_io_pool> io_pool) :
     state(request_state::created),
     req(std::move(*static_cast<sl::pion::http_request_ptr*>(req))),
     resp(std::move(*static_cast<sl::pion::response_writer_ptr*> (resp))),
     mustache_templates(mustache_templates),
-    mustache_partials(mustache_partials) { }
+    io_pool(std::move(io_pool)) { }
 
     impl(void* /* sl::pion::websocket_ptr&& */ wsocket, bool response_allowed) :
     state(response_allowed ? request_state::created : request_state::committed),
@@ -116,6 +118,12 @@ public:
         return request_payload_handler::get_data_string(req);
     }
 
+    sl::io::span<const char> get_request_data_span(request&) {
+        if (websocket_active) throw support::exception(TRACEMSG(
+                "Data span not supported with WebSocket"));
+        return request_payload_handler::get_data_span(req);
+    }
+
     support::buffer get_request_data_buffer(request&) {
         if (!websocket_active) throw support::exception(TRACEMSG(
                 "Buffer data not supported with HTTP"));
@@ -126,6 +134,10 @@ public:
     sl::json::value get_request_form_data(request&) {
         if (websocket_active) throw support::exception(TRACEMSG(
                 "Form data not supported with WebSocket"));
+        auto multipart = request_payload_handler::get_multipart(req);
+        if (nullptr != multipart) {
+            return multipart->fields_json();
+        }
         const std::string& data = request_payload_handler::get_data_string(req);
         auto dict = std::unordered_multimap<std::string, std::string, sl::pion::algorithm::ihash, sl::pion::algorithm::iequal_to>();
         auto err = sl::pion::http_parser::parse_url_encoded(dict, data);
@@ -138,6 +150,16 @@ public:
         return sl::json::value(std::move(res));
     }
 
+    sl::json::value get_request_multipart_data(request&) {
+        if (websocket_active) throw support::exception(TRACEMSG(
+                "Multipart data not supported with WebSocket"));
+        auto multipart = request_payload_handler::get_multipart(req);
+        if (nullptr == multipart) throw support::exception(TRACEMSG(
+                "Request body was not parsed as 'multipart/form-data'," +
+                " check 'requestPayload.parseMultipart' option and 'Content-Type' header"));
+        return multipart->to_json();
+    }
+
     const std::string& get_request_data_filename(request&) {
         if (websocket_active) throw support::exception(TRACEMSG(
                 "Persistent request data not supported with WebSocket"));
@@ -173,13 +195,25 @@ public:
     void send_file(request&, std::string file_path, std::function<void(bool)> finalizer) {
         if (websocket_active) throw support::exception(TRACEMSG(
                 "Files sending not supported with WebSocket"));
+        auto file = native_file::open(file_path);
+        if (nullptr != file.get() && file->is_regular_file()) {
+            auto state_expected = request_state::created;
+            if (!state.compare_exchange_strong(state_expected, request_state::committed,
+                    std::memory_order_acq_rel, std::memory_order_relaxed)) throw support::exception(TRACEMSG(
+                    "Invalid request lifecycle operation, request is already committed"));
+            auto size = file->size();
+            send_native_file(*req, std::move(resp), std::move(file), 0, size, "", "",
+                    std::move(finalizer), io_pool);
+            return;
+        }
         auto fd = sl::tinydir::file_source(file_path);
         auto state_expected = request_state::created;
         if (!state.compare_exchange_strong(state_expected, request_state::committed,
                 std::memory_order_acq_rel, std::memory_order_relaxed)) throw support::exception(TRACEMSG(
                 "Invalid request lifecycle operation, request is already committed"));
         auto fd_ptr = sl::io::make_source_istream_ptr(std::move(fd));
-        auto sender = sl::support::make_unique<response_stream_sender>(std::move(resp), std::move(fd_ptr), std::move(finalizer));
+        auto sender = sl::support::make_unique<response_stream_sender>(std::move(resp), std::move(fd_ptr),
+                std::move(finalizer), io_pool);
         sender->send(std::move(sender));
     }
 
@@ -196,10 +230,15 @@ public:
             }
             return mustache_file_path;
         } ();
-        const std::string& cached_template = mustache_templates->get(mpath);
-        auto mp = sl::mustache::source(std::move(json), cached_template, *mustache_partials);
-        auto mp_ptr = sl::io::make_source_istream_ptr(std::move(mp));
-        auto sender = sl::support::make_unique<response_stream_sender>(std::move(resp), std::move(mp_ptr));
+        auto output = mustache_templates->render(mpath, std::move(json));
+        if (nullptr != output.body.get()) {
+            // sent with 'Content-Length', pooled buffer is released when the write completes
+            auto sender = sl::support::make_unique<response_memory_sender>(std::move(resp), std::move(output.body));
+            sender->send(std::move(sender));
+            return;
+        }
+        auto sender = sl::support::make_unique<response_stream_sender>(std::move(resp), std::move(output.stream),
+                [](bool){}, io_pool);
         sender->send(std::move(sender));
     }
     
@@ -311,12 +350,14 @@ private:
     }
 
 };
-PIMPL_FORWARD_CONSTRUCTOR(request, (void*)(void*)(mustache_cache&)(partmap_type), (), support::exception)
+PIMPL_FORWARD_CONSTRUCTOR(request, (void*)(void*)(mustache_cache&)(io_pool_type), (), support::exception)
 PIMPL_FORWARD_CONSTRUCTOR(request, (void*)(bool), (), support::exception)
 PIMPL_FORWARD_METHOD(request, server::conf::request_metadata, get_request_metadata, (), (), support::exception)
 PIMPL_FORWARD_METHOD(request, const std::string&, get_request_data, (), (), support::exception)
+PIMPL_FORWARD_METHOD(request, sl::io::span<const char>, get_request_data_span, (), (), support::exception)
 PIMPL_FORWARD_METHOD(request, support::buffer, get_request_data_buffer, (), (), support::exception)
 PIMPL_FORWARD_METHOD(request, sl::json::value, get_request_form_data, (), (), support::exception)
+PIMPL_FORWARD_METHOD(request, sl::json::value, get_request_multipart_data, (), (), support::exception)
 PIMPL_FORWARD_METHOD(request, const std::string&, get_request_data_filename, (), (), support::exception)
 PIMPL_FORWARD_METHOD(request, void, set_response_metadata, (server::conf::response_metadata), (), support::exception)
 PIMPL_FORWARD_METHOD(request, void, send_response, (sl::io::span<const char>), (), support::exception)
@@ -27,6 +27,7 @@
 #include <cstdint>
 #include <functional>
 #include <map>
+#include <memory>
 #include <string>
 
 #include "staticlib/pimpl.hpp"
@@ -36,6 +37,7 @@
 #include "wilton/support/buffer.hpp"
 #include "wilton/support/exception.hpp"
 
+#include "blocking_io_pool.hpp"
 #include "conf/response_metadata.hpp"
 #include "conf/request_metadata.hpp"
 #include "mustache_cache.hpp"
@@ -63,10 +65,14 @@ public:
     
     const std::string& get_request_data();
 
+    sl::io::span<const char> get_request_data_span();
+
     support::buffer get_request_data_buffer();
 
     sl::json::value get_request_form_data();
     
+    sl::json::value get_request_multipart_data();
+
     const std::string& get_request_data_filename();
     
     void set_response_metadata(server::conf::response_metadata rm);
@@ -90,7 +96,7 @@ public:
     request(void* /* sl::pion::http_request_ptr&& */ req, 
             void* /* sl::pion::http_response_writer_ptr&& */ resp,
             mustache_cache& mustache_templates,
-            const std::map<std::string, std::string>& mustache_partials);
+            std::shared_ptr<blocking_io_pool> io_pool);
 
     request(void* /* sl::pion::websocket_ptr&& */ ws, bool response_allowed = true);
 };
@@ -26,6 +26,8 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <cstdlib>
+#include <algorithm>
 #include <array>
 #include <exception>
 #include <functional>
@@ -41,6 +43,10 @@
 #include "wilton/support/exception.hpp"
 
 #include "conf/request_payload_config.hpp"
+#include "mapped_file.hpp"
+#include "multipart_parser.hpp"
+#include "native_file.hpp"
+#include "payload_buffer_pool.hpp"
 
 namespace wilton {
 namespace server {
@@ -52,17 +58,26 @@ class request_payload_handler {
 
     class payload_data {
         friend class request_payload_handler;
-        server::conf::request_payload_config conf;
         uint64_t counter = 0;
-        std::string buffer = "";
+        std::string buffer;
         std::string filename;
         std::unique_ptr<sl::tinydir::file_sink> file;
         payload_state state = payload_state::memory;
         std::unique_ptr<sl::utils::random_string_generator> rng;
+        // set if body is parsed as 'multipart/form-data'
+        std::unique_ptr<multipart_parser> multipart;
+        // spooled body mapping, created on first access
+        std::shared_ptr<mapped_file> mapping;
+        // spooled body is empty and cannot be mapped
+        bool empty_file = false;
 
     public:
-        payload_data(const server::conf::request_payload_config& conf) :
-        conf(conf.clone()) { }
+        payload_data(size_t expected_size) :
+        buffer(expected_size > 0 ? payload_buffer_pool::local().acquire(expected_size) : std::string()) { }
+
+        ~payload_data() STATICLIB_NOEXCEPT {
+            payload_buffer_pool::local().release(std::move(buffer));
+        }
 
         sl::utils::random_string_generator& randomgen() {
             if (nullptr == rng.get()) {
@@ -75,21 +90,39 @@ class request_payload_handler {
         payload_data& operator=(const payload_data&) = delete;
     };
 
+    std::shared_ptr<const server::conf::request_payload_config> conf;
+    // value of 'Content-Length' header, zero if not specified
+    uint64_t content_length;
+    // empty if multipart parsing is not used for this request
+    std::string multipart_boundary;
+    // created when the first part of the body is received
     std::shared_ptr<payload_data> data;
 
 public:
     request_payload_handler(const request_payload_handler& other) :
+    conf(other.conf),
+    content_length(other.content_length),
+    multipart_boundary(other.multipart_boundary),
     data(other.data) { }
 
     request_payload_handler& operator=(const request_payload_handler& other) {
+        conf = other.conf;
+        content_length = other.content_length;
+        multipart_boundary = other.multipart_boundary;
         data = other.data;
         return *this;
     }
 
     request_payload_handler(request_payload_handler&& other) :
+    conf(std::move(other.conf)),
+    content_length(other.content_length),
+    multipart_boundary(std::move(other.multipart_boundary)),
     data(std::move(other.data)) { }
 
     request_payload_handler& operator=(request_payload_handler&& other) {
+        conf = std::move(other.conf);
+        content_length = other.content_length;
+        multipart_boundary = std::move(other.multipart_boundary);
         data = std::move(other.data);
         return *this;
     }
@@ -105,8 +138,12 @@ public:
         }
     }
     
-    request_payload_handler(const server::conf::request_payload_config& conf) : 
-    data(std::make_shared<payload_data>(conf)) { }
+    request_payload_handler(std::shared_ptr<const server::conf::request_payload_config> conf,
+            const std::string& content_length_header, const std::string& content_type_header) :
+    conf(std::move(conf)),
+    content_length(parse_content_length(content_length_header)),
+    multipart_boundary(this->conf->parseMultipart ?
+            multipart_parser::extract_boundary(content_type_header) : std::string()) { }
 
     static const std::string& get_data_string(sl::pion::http_request_ptr& request) {
         auto ph = request->get_payload_handler<request_payload_handler>();
@@ -120,15 +157,51 @@ public:
         return ph->get_data_as_filename();
     }
 
+    /**
+     * Request body as a read-only span, body spooled to 'tmpDirPath'
+     * is mapped into memory instead of being read back, span stays
+     * valid while request exists
+     *
+     * @param request HTTP request
+     * @return body span
+     */
+    static sl::io::span<const char> get_data_span(sl::pion::http_request_ptr& request) {
+        auto ph = request->get_payload_handler<request_payload_handler>();
+        if (!ph) throw support::exception(TRACEMSG("System error in payload handler access"));
+        return ph->get_data_as_span();
+    }
+
+    /**
+     * Parsed multipart body
+     *
+     * @param request HTTP request
+     * @return parser or null if body was not parsed as 'multipart/form-data'
+     */
+    static const multipart_parser* get_multipart(sl::pion::http_request_ptr& request) {
+        auto ph = request->get_payload_handler<request_payload_handler>();
+        if (!ph) throw support::exception(TRACEMSG("System error in payload handler access"));
+        return ph->get_multipart_parser();
+    }
+
     void operator()(const char* s, size_t n) {
+        if (nullptr == data.get()) {
+            if (0 == n) {
+                return;
+            }
+            create_data(n);
+        }
+        if (nullptr != data->multipart.get()) {
+            data->multipart->consume(s, n);
+            return;
+        }
         switch (data->state) {
         case payload_state::memory:
-            if (data->buffer.length() + n < data->conf.memoryLimitBytes) {
+            if (data->buffer.length() + n < conf->memoryLimitBytes) {
                 data->buffer.append(s, n);
                 return;
-            } else if (data->conf.tmpDirPath.empty()) {
+            } else if (conf->tmpDirPath.empty()) {
                 throw support::exception(TRACEMSG("Request body exceeds" +
-                        " limit (bytes): [" + sl::support::to_string(data->conf.memoryLimitBytes) + "]"));
+                        " limit (bytes): [" + sl::support::to_string(conf->memoryLimitBytes) + "]"));
             } else {
                 data->state = payload_state::file;
                 data->filename = gen_filename();
@@ -150,13 +223,58 @@ public:
     }
 
 private:
-    payload_data& get_data() {
-        return *data;
+    static uint64_t parse_content_length(const std::string& header) {
+        if (header.empty() || header.length() > 19 ||
+                std::string::npos != header.find_first_not_of("0123456789")) {
+            return 0;
+        }
+        return static_cast<uint64_t>(std::strtoull(header.c_str(), nullptr, 10));
+    }
+
+    void create_data(size_t first_part_len) {
+        if (!multipart_boundary.empty()) {
+            data = std::make_shared<payload_data>(0);
+            auto conf_copy = conf;
+            auto data_ptr = data.get();
+            // parser is owned by payload data
+            data->multipart.reset(new multipart_parser(multipart_boundary, conf->memoryLimitBytes,
+                    [conf_copy, data_ptr] {
+                        return gen_filename(*conf_copy, *data_ptr);
+                    }));
+            return;
+        }
+        // whole body is expected to fit into the buffer, 'Content-Length' is
+        // not trusted beyond the largest pooled buffer, buffer grows as data arrives
+        size_t expected = first_part_len;
+        if (content_length > expected && content_length < conf->memoryLimitBytes) {
+            expected = static_cast<size_t>(std::min(content_length,
+                    static_cast<uint64_t>(payload_buffer_pool::max_pooled_bytes())));
+            expected = std::max(expected, first_part_len);
+        }
+        data = std::make_shared<payload_data>(expected);
     }
 
     std::string gen_filename() {
-        return data->conf.tmpDirPath + "/" + sl::support::to_string(data->counter++) + "_" +
-                data->randomgen().generate(data->conf.tmpFilenameLength);
+        return gen_filename(*conf, *data);
+    }
+
+    static std::string gen_filename(const server::conf::request_payload_config& cf, payload_data& pd) {
+        return cf.tmpDirPath + "/" + sl::support::to_string(pd.counter++) + "_" +
+                pd.randomgen().generate(cf.tmpFilenameLength);
+    }
+
+    const multipart_parser* get_multipart_parser() {
+        if (nullptr == data.get() || nullptr == data->multipart.get()) {
+            return nullptr;
+        }
+        if (!data->multipart->is_complete()) throw support::exception(TRACEMSG(
+                "Invalid 'multipart/form-data' body, final boundary not found"));
+        return data->multipart.get();
+    }
+
+    void check_not_multipart() {
+        if (nullptr != data.get() && nullptr != data->multipart.get()) throw support::exception(TRACEMSG(
+                "Request body was parsed as 'multipart/form-data', raw body is not available"));
     }
     
     void close_file_writer() {
@@ -164,6 +282,10 @@ private:
     }
 
     const std::string& get_data_as_string() {
+        if (nullptr == data.get()) {
+            return sl::utils::empty_string();
+        }
+        check_not_multipart();
         close_file_writer();
         switch (data->state) {
         case payload_state::file: {
@@ -180,7 +302,39 @@ private:
         }
     }
 
+    sl::io::span<const char> get_data_as_span() {
+        if (nullptr == data.get()) {
+            return sl::io::span<const char>(sl::utils::empty_string().data(), 0);
+        }
+        check_not_multipart();
+        if (payload_state::file == data->state && data->empty_file) {
+            return sl::io::span<const char>(sl::utils::empty_string().data(), 0);
+        }
+        if (payload_state::file == data->state && nullptr == data->mapping.get() &&
+                native_file::is_supported()) {
+            close_file_writer();
+            auto file = native_file::open(data->filename);
+            if (nullptr == file.get()) throw support::exception(TRACEMSG(
+                    "Error opening request body file, path: [" + data->filename + "]"));
+            if (0 == file->size()) {
+                data->empty_file = true;
+                return sl::io::span<const char>(sl::utils::empty_string().data(), 0);
+            }
+            data->mapping = mapped_file::map(std::move(file));
+        }
+        if (nullptr != data->mapping.get()) {
+            return sl::io::span<const char>(data->mapping->data(), static_cast<size_t>(data->mapping->size()));
+        }
+        // body in memory or mapping is not supported
+        const std::string& str = get_data_as_string();
+        return sl::io::span<const char>(str.data(), str.length());
+    }
+
     const std::string& get_data_as_filename() {
+        if (nullptr == data.get()) {
+            create_data(0);
+        }
+        check_not_multipart();
         close_file_writer();
         switch (data->state) {
         case payload_state::memory:
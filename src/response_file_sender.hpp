@@ -0,0 +1,259 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   response_file_sender.hpp
+ * Author: alex
+ *
+ * Created on October 17, 2026, 10:40 AM
+ */
+
+#ifndef WILTON_SERVER_RESPONSE_FILE_SENDER_HPP
+#define WILTON_SERVER_RESPONSE_FILE_SENDER_HPP
+
+#include <cerrno>
+#include <cstdint>
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#ifdef STATICLIB_LINUX
+#include <sys/sendfile.h>
+#endif // STATICLIB_LINUX
+
+#include "asio.hpp"
+
+#include "staticlib/pion.hpp"
+#include "staticlib/support.hpp"
+
+#include "blocking_io_pool.hpp"
+#include "http_range.hpp"
+#include "native_file.hpp"
+#include "response_stream_sender.hpp"
+
+namespace wilton {
+namespace server {
+
+namespace { // anonymous
+
+// single 'sendfile' call limit, allows to re-check connection state between calls
+const uint64_t max_chunk_size = 1 << 20;
+
+} // namespace
+
+/**
+ * Sends a byte range of a regular file with a 'Content-Length' header,
+ * body is passed to the kernel with 'sendfile(2)' directly from the file
+ * descriptor to the socket, can be used only for plain HTTP connections;
+ * with null file only the header block is sent (e.g. for HEAD requests),
+ * that works for TLS connections too
+ */
+class response_file_sender {
+    sl::pion::response_writer_ptr writer;
+    std::shared_ptr<native_file> file;
+    uint64_t offset;
+    uint64_t remaining;
+    std::function<void(bool)> finalizer;
+    // accounts time spent in 'sendfile', may be null
+    std::shared_ptr<blocking_io_pool> io_pool;
+
+    std::vector<asio::const_buffer> head;
+
+public:
+    response_file_sender(sl::pion::response_writer_ptr writer,
+            std::shared_ptr<native_file> file, uint64_t offset, uint64_t length,
+            std::function<void(bool)> finalizer = [](bool){},
+            std::shared_ptr<blocking_io_pool> io_pool = std::shared_ptr<blocking_io_pool>()) :
+    writer(std::move(writer)),
+    file(std::move(file)),
+    offset(offset),
+    remaining(length),
+    finalizer(std::move(finalizer)),
+    io_pool(std::move(io_pool)) { }
+
+    /**
+     * TLS connections and non-Linux platforms must use
+     * 'response_stream_sender' instead
+     *
+     * @param writer response writer
+     * @param file opened file
+     * @return whether file can be sent with this sender
+     */
+    static bool is_supported(const sl::pion::response_writer_ptr& writer, const native_file& file) {
+#ifdef STATICLIB_LINUX
+        return file.is_regular_file() && !writer->get_connection()->get_ssl_flag();
+#else
+        (void) writer;
+        (void) file;
+        return false;
+#endif // STATICLIB_LINUX
+    }
+
+    static void send(std::unique_ptr<response_file_sender> self) {
+        auto& resp = self->writer->get_response();
+        resp.set_content_length(self->remaining);
+        auto conn = self->writer->get_connection();
+        resp.prepare_buffers_for_send(self->head, conn->get_keep_alive(), false);
+        if (nullptr == self->file.get()) {
+            self->remaining = 0;
+        }
+        auto& head = self->head;
+        auto self_shared = sl::support::make_shared_with_release_deleter(self.release());
+        conn->async_write(head,
+            [self_shared](const std::error_code& ec, size_t) {
+                auto self = sl::support::make_unique_from_shared_with_release_deleter(self_shared);
+                if (nullptr != self.get()) {
+                    handle_write(std::move(self), ec);
+                }
+            });
+    }
+
+private:
+    static void handle_write(std::unique_ptr<response_file_sender> self, std::error_code ec) {
+#ifdef STATICLIB_LINUX
+        auto& sock = self->writer->get_connection()->get_socket();
+        if (!ec && self->remaining > 0 && !sock.native_non_blocking()) {
+            sock.native_non_blocking(true, ec);
+        }
+        while (!ec && self->remaining > 0) {
+            off_t off = static_cast<off_t>(self->offset);
+            size_t chunk = static_cast<size_t>(std::min(self->remaining, max_chunk_size));
+            // page cache misses block the calling IO thread
+            auto start = std::chrono::steady_clock::now();
+            auto res = ::sendfile(sock.native_handle(), self->file->handle(), std::addressof(off), chunk);
+            if (nullptr != self->io_pool.get()) {
+                self->io_pool->add_io_thread_blocked(std::chrono::steady_clock::now() - start);
+            }
+            if (res > 0) {
+                self->offset += static_cast<uint64_t>(res);
+                self->remaining -= static_cast<uint64_t>(res);
+            } else if (0 == res) {
+                // file was truncated after 'Content-Length' was sent
+                ec = std::make_error_code(std::errc::io_error);
+            } else if (EINTR == errno) {
+                continue;
+            } else if (EAGAIN == errno || EWOULDBLOCK == errno) {
+                // wait until socket becomes writable
+                auto self_shared = sl::support::make_shared_with_release_deleter(self.release());
+                sock.async_write_some(asio::null_buffers(),
+                    [self_shared](const std::error_code& ec, size_t) {
+                        auto self = sl::support::make_unique_from_shared_with_release_deleter(self_shared);
+                        if (nullptr != self.get()) {
+                            handle_write(std::move(self), ec);
+                        }
+                    });
+                return;
+            } else {
+                ec = std::error_code(errno, std::system_category());
+            }
+        }
+#endif // STATICLIB_LINUX
+        if (!ec) {
+            auto conn = self->writer->get_connection();
+            self->finalizer(true);
+            conn->finish();
+        } else {
+            // make sure it will get closed
+            self->writer->get_connection()->set_lifecycle(sl::pion::tcp_connection::lifecycle::close);
+            self->finalizer(false);
+        }
+    }
+
+};
+
+/**
+ * Sends a part of an opened regular file as a response body, 'Range'
+ * request header is honoured, 'Content-Type' must be already set
+ *
+ * @param req HTTP request
+ * @param resp response writer
+ * @param file opened regular file
+ * @param offset body offset within the file
+ * @param size body size
+ * @param etag entity tag used to check 'If-Range'
+ * @param last_modified modification date used to check 'If-Range'
+ * @param finalizer called after the response is sent
+ * @param io_pool pool for reads that cannot be done with 'sendfile', may be null
+ */
+inline void send_native_file(const sl::pion::http_request& req, sl::pion::response_writer_ptr resp,
+        std::shared_ptr<native_file> file, uint64_t offset, uint64_t size,
+        const std::string& etag = std::string(), const std::string& last_modified = std::string(),
+        std::function<void(bool)> finalizer = [](bool){},
+        std::shared_ptr<blocking_io_pool> io_pool = std::shared_ptr<blocking_io_pool>()) {
+    auto& rp = resp->get_response();
+    rp.change_header("Accept-Ranges", "bytes");
+    auto ranges = std::vector<byte_range>();
+    auto status = read_request_ranges(req, size, etag, last_modified, ranges);
+    if (range_status::unsatisfiable == status) {
+        send416(std::move(resp), size);
+        finalizer(true);
+        return;
+    }
+    if (range_status::satisfiable == status && (ranges.size() > 1 ||
+            !response_file_sender::is_supported(resp, *file))) {
+        auto ct = std::string(rp.get_header("Content-Type"));
+        auto boundary = set_partial_headers(rp, ranges, size);
+        auto reader = [file, offset](sl::io::span<char> span, uint64_t pos) {
+            return file->read_at(span, offset + pos);
+        };
+        auto src = byte_ranges_source(std::move(reader), std::move(ranges), boundary, ct, size);
+        auto body_length = src.total_length();
+        auto src_ptr = sl::io::make_source_istream_ptr(std::move(src));
+        auto sender = sl::support::make_unique<response_stream_sender>(std::move(resp),
+                std::move(src_ptr), body_length, std::move(finalizer), std::move(io_pool));
+        sender->send(std::move(sender));
+        return;
+    }
+    uint64_t first = 0;
+    uint64_t length = size;
+    if (range_status::satisfiable == status) {
+        set_partial_headers(rp, ranges, size);
+        first = ranges.front().first;
+        length = ranges.front().length();
+    }
+    if (response_file_sender::is_supported(resp, *file)) {
+        auto sender = sl::support::make_unique<response_file_sender>(std::move(resp),
+                std::move(file), offset + first, length, std::move(finalizer), std::move(io_pool));
+        sender->send(std::move(sender));
+    } else {
+        // TLS connection
+        auto src = native_file_source(std::move(file), offset + first, length);
+        auto src_ptr = sl::io::make_source_istream_ptr(std::move(src));
+        auto sender = sl::support::make_unique<response_stream_sender>(std::move(resp),
+                std::move(src_ptr), length, std::move(finalizer), std::move(io_pool));
+        sender->send(std::move(sender));
+    }
+}
+
+/**
+ * Sends the header block with the specified 'Content-Length'
+ * and without a body, used to answer HEAD requests
+ *
+ * @param resp response writer
+ * @param content_length length of the body that GET request would return
+ */
+inline void send_head(sl::pion::response_writer_ptr resp, uint64_t content_length) {
+    auto sender = sl::support::make_unique<response_file_sender>(std::move(resp),
+            std::shared_ptr<native_file>(), 0, content_length);
+    sender->send(std::move(sender));
+}
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_RESPONSE_FILE_SENDER_HPP */
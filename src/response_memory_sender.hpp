@@ -0,0 +1,103 @@
+/*
+ * Copyright 2026, alex at staticlibs.net
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * File:   response_memory_sender.hpp
+ * Author: alex
+ *
+ * Created on October 18, 2026, 3:40 PM
+ */
+
+#ifndef WILTON_SERVER_RESPONSE_MEMORY_SENDER_HPP
+#define WILTON_SERVER_RESPONSE_MEMORY_SENDER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "asio.hpp"
+
+#include "staticlib/pion.hpp"
+#include "staticlib/support.hpp"
+
+namespace wilton {
+namespace server {
+
+/**
+ * Sends a shared in-memory body with a 'Content-Length' header,
+ * header block and body are passed to the connection in a single
+ * gathered write without copying the body
+ */
+class response_memory_sender {
+    sl::pion::response_writer_ptr writer;
+    // keeps body memory alive until the write completes
+    std::shared_ptr<const void> owner;
+    const char* data;
+    size_t length;
+
+    std::vector<asio::const_buffer> buffers;
+
+public:
+    response_memory_sender(sl::pion::response_writer_ptr writer, std::shared_ptr<const std::string> body) :
+    writer(std::move(writer)),
+    owner(body),
+    data(body->data()),
+    length(body->length()) { }
+
+    /**
+     * Sends a region of memory owned by another object, e.g. a file mapping
+     *
+     * @param writer response writer
+     * @param owner object that owns the memory
+     * @param data body start
+     * @param length body length
+     */
+    response_memory_sender(sl::pion::response_writer_ptr writer, std::shared_ptr<const void> owner,
+            const char* data, size_t length) :
+    writer(std::move(writer)),
+    owner(std::move(owner)),
+    data(data),
+    length(length) { }
+
+    static void send(std::unique_ptr<response_memory_sender> self) {
+        auto& resp = self->writer->get_response();
+        resp.set_content_length(self->length);
+        auto conn = self->writer->get_connection();
+        resp.prepare_buffers_for_send(self->buffers, conn->get_keep_alive(), false);
+        self->buffers.emplace_back(asio::buffer(self->data, self->length));
+        auto& buffers = self->buffers;
+        auto self_shared = sl::support::make_shared_with_release_deleter(self.release());
+        conn->async_write(buffers,
+            [self_shared](const std::error_code& ec, size_t) {
+                auto self = sl::support::make_unique_from_shared_with_release_deleter(self_shared);
+                if (nullptr != self.get()) {
+                    auto conn = self->writer->get_connection();
+                    if (!ec) {
+                        conn->finish();
+                    } else {
+                        // make sure it will get closed
+                        conn->set_lifecycle(sl::pion::tcp_connection::lifecycle::close);
+                    }
+                }
+            });
+    }
+
+};
+
+} // namespace
+}
+
+#endif /* WILTON_SERVER_RESPONSE_MEMORY_SENDER_HPP */
@@ -24,70 +24,261 @@
 #ifndef WILTON_SERVER_RESPONSE_STREAM_SENDER_HPP
 #define WILTON_SERVER_RESPONSE_STREAM_SENDER_HPP
 
+#include <cstdint>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
 #include <istream>
 #include <memory>
+#include <vector>
 
 #include "asio.hpp"
 
+#include "staticlib/config.hpp"
 #include "staticlib/pion.hpp"
 
 #include "staticlib/io.hpp"
 
+#include "blocking_io_pool.hpp"
+
 namespace wilton {
 namespace server {
 
+namespace { // anonymous
+
+// used when body length is not known, grows twice on every full read
+const size_t stream_buffer_initial_size = 16384;
+
+const size_t stream_buffer_min_size = 4096;
+
+const size_t stream_buffer_max_size = 1 << 20;
+
+} // namespace
+
+/**
+ * Sends a stream as a response body, chunked transfer encoding is used
+ * when the body length is not known beforehand, otherwise body is written
+ * with a 'Content-Length' header; two buffers are used, next part of the
+ * stream is read while the previous one is being written, reads are done
+ * on the blocking IO pool when it is specified and has threads
+ */
 class response_stream_sender {
+    using continuation = void(*)(const std::shared_ptr<response_stream_sender>&);
+
     sl::pion::response_writer_ptr writer;
     std::unique_ptr<std::istream> stream;
     std::function<void(bool)> finalizer;
+    std::shared_ptr<blocking_io_pool> io_pool;
+    bool length_known;
+    uint64_t content_length;
+    // bytes not yet read from the stream
+    uint64_t remaining;
 
-    std::array<char, 4096> buf;
+    size_t capacity;
+    std::array<std::vector<char>, 2> bufs;
+    size_t current = 0;
+    size_t ready_len = 0;
+    size_t next_len = 0;
+    bool exhausted = false;
+    bool truncated = false;
+    bool read_failed = false;
+    bool last_write = false;
+    std::vector<asio::const_buffer> head;
+
+    // write completion and read of the next part are joined on the second of them
+    std::atomic<int> joins;
+    std::error_code write_ec;
 
 public:
     response_stream_sender(sl::pion::response_writer_ptr writer, 
             std::unique_ptr<std::istream> stream, 
-            std::function<void(bool)> finalizer = [](bool){}) :
+            std::function<void(bool)> finalizer = [](bool){},
+            std::shared_ptr<blocking_io_pool> io_pool = std::shared_ptr<blocking_io_pool>()) :
     writer(std::move(writer)),
     stream(std::move(stream)),
-    finalizer(std::move(finalizer)) { }
+    finalizer(std::move(finalizer)),
+    io_pool(std::move(io_pool)),
+    length_known(false),
+    content_length(0),
+    remaining(0),
+    capacity(stream_buffer_initial_size),
+    joins(0) { }
+
+    response_stream_sender(sl::pion::response_writer_ptr writer,
+            std::unique_ptr<std::istream> stream, uint64_t content_length,
+            std::function<void(bool)> finalizer = [](bool){},
+            std::shared_ptr<blocking_io_pool> io_pool = std::shared_ptr<blocking_io_pool>()) :
+    writer(std::move(writer)),
+    stream(std::move(stream)),
+    finalizer(std::move(finalizer)),
+    io_pool(std::move(io_pool)),
+    length_known(true),
+    content_length(content_length),
+    remaining(content_length),
+    capacity(static_cast<size_t>(std::max(static_cast<uint64_t>(stream_buffer_min_size),
+            std::min(content_length, static_cast<uint64_t>(stream_buffer_max_size))))),
+    joins(0) { }
+
+    response_stream_sender(const response_stream_sender&) = delete;
+
+    response_stream_sender& operator=(const response_stream_sender&) = delete;
 
     static void send(std::unique_ptr<response_stream_sender> self) {
-        std::error_code ec;
-        self->handle_write(std::move(self), ec, 0);
+        if (self->length_known) {
+            auto& resp = self->writer->get_response();
+            resp.set_content_length(self->content_length);
+            auto conn = self->writer->get_connection();
+            // first part of the body is sent along with the header block
+            resp.prepare_buffers_for_send(self->head, conn->get_keep_alive(), false);
+        }
+        auto idx = self->current;
+        auto self_shared = sl::support::make_shared_with_release_deleter(self.release());
+        read_async(self_shared, idx, [](const std::shared_ptr<response_stream_sender>& self_shared) {
+            auto self = sl::support::make_unique_from_shared_with_release_deleter(self_shared);
+            if (nullptr != self.get()) {
+                self->ready_len = self->next_len;
+                write_current(std::move(self));
+            }
+        });
     }
 
-    static void handle_write(std::unique_ptr<response_stream_sender> self,
-            const std::error_code& ec, size_t /* bytes_written */) {
-        if (!ec) {
-            auto src = sl::io::streambuf_source(self->stream->rdbuf());
-            size_t len = sl::io::read_all(src, self->buf);
-            self->writer->clear();
-            if (len > 0) {
-                if (self->buf.size() == len) {
-                    self->writer->write_nocopy({self->buf.data(), len});
-                    auto& wr = self->writer;
-                    auto self_shared = sl::support::make_shared_with_release_deleter(self.release());
-                    wr->send_chunk(
-                        [self_shared](const std::error_code& ec, size_t bt) {
-                            auto self = sl::support::make_unique_from_shared_with_release_deleter(self_shared);
-                            if (nullptr != self.get()) {
-                                handle_write(std::move(self), ec, bt);
-                            }
-                        });
-                } else {
-                    self->writer->write({self->buf.data(), len});
-                    self->writer->send_final_chunk(std::move(self->writer));
-                    self->finalizer(true);
-                }
-            } else {
-                self->writer->send_final_chunk(std::move(self->writer));
-                self->finalizer(true);
-            }
+private:
+    static void write_current(std::unique_ptr<response_stream_sender> self) {
+        if (self->read_failed) {
+            fail(std::move(self));
+            return;
+        }
+        if (!self->length_known && self->exhausted) {
+            send_final_chunk(std::move(self));
+            return;
+        }
+        bool prefetch = !self->exhausted;
+        self->last_write = !prefetch;
+        self->joins.store(0, std::memory_order_release);
+        auto raw = self.get();
+        auto self_shared = sl::support::make_shared_with_release_deleter(self.release());
+        auto handler = [self_shared](const std::error_code& ec, size_t) {
+            self_shared->write_ec = ec;
+            join(self_shared);
+        };
+        auto& buf = raw->bufs[raw->current];
+        if (raw->length_known) {
+            raw->head.emplace_back(asio::buffer(buf.data(), raw->ready_len));
+            raw->writer->get_connection()->async_write(raw->head, handler);
+        } else {
+            raw->writer->clear();
+            raw->writer->write_nocopy({buf.data(), raw->ready_len});
+            raw->writer->send_chunk(handler);
+        }
+        if (prefetch) {
+            read_async(self_shared, 1 - raw->current, join);
+        } else {
+            join(self_shared);
+        }
+    }
+
+    // reads next part of the stream into the specified buffer, 'cont' is called on IO thread
+    static void read_async(const std::shared_ptr<response_stream_sender>& self_shared, size_t idx,
+            continuation cont) {
+        auto raw = self_shared.get();
+        auto pool = raw->io_pool.get();
+        if (nullptr == pool) {
+            raw->next_len = raw->read_noexcept(idx);
+            cont(self_shared);
+        } else if (!pool->has_workers()) {
+            raw->next_len = pool->run_inline([raw, idx] {
+                return raw->read_noexcept(idx);
+            });
+            cont(self_shared);
         } else {
-            // make sure it will get closed
-            self->writer->get_connection()->set_lifecycle(sl::pion::tcp_connection::lifecycle::close);
-            self->finalizer(false);
+            pool->submit([self_shared, idx, cont] {
+                self_shared->next_len = self_shared->read_noexcept(idx);
+                auto& ios = self_shared->writer->get_connection()->get_io_service();
+                ios.post([self_shared, cont] {
+                    cont(self_shared);
+                });
+            }, [self_shared, cont] {
+                // pool is stopped, failed read closes the connection and calls the finalizer
+                self_shared->read_failed = true;
+                self_shared->exhausted = true;
+                self_shared->next_len = 0;
+                cont(self_shared);
+            });
+        }
+    }
+
+    static void join(const std::shared_ptr<response_stream_sender>& self_shared) {
+        if (1 != self_shared->joins.fetch_add(1, std::memory_order_acq_rel)) {
+            return;
+        }
+        auto self = sl::support::make_unique_from_shared_with_release_deleter(self_shared);
+        if (nullptr == self.get()) {
+            return;
+        }
+        self->head.clear();
+        if (self->write_ec || self->truncated || self->read_failed) {
+            fail(std::move(self));
+            return;
+        }
+        if (self->length_known && self->last_write) {
+            auto conn = self->writer->get_connection();
+            self->finalizer(true);
+            conn->finish();
+            return;
+        }
+        self->current = 1 - self->current;
+        self->ready_len = self->next_len;
+        write_current(std::move(self));
+    }
+
+    static void send_final_chunk(std::unique_ptr<response_stream_sender> self) {
+        self->writer->clear();
+        if (self->ready_len > 0) {
+            self->writer->write({self->bufs[self->current].data(), self->ready_len});
+        }
+        self->writer->send_final_chunk(std::move(self->writer));
+        self->finalizer(true);
+    }
+
+    static void fail(std::unique_ptr<response_stream_sender> self) {
+        // make sure it will get closed
+        self->writer->get_connection()->set_lifecycle(sl::pion::tcp_connection::lifecycle::close);
+        self->finalizer(false);
+    }
+
+    size_t read_noexcept(size_t idx) STATICLIB_NOEXCEPT {
+        try {
+            return read_into(idx);
+        } catch (const std::exception&) {
+            read_failed = true;
+            exhausted = true;
+            return 0;
+        }
+    }
+
+    size_t read_into(size_t idx) {
+        auto& buf = bufs[idx];
+        if (buf.size() < capacity) {
+            buf.resize(capacity);
+        }
+        size_t limit = length_known ?
+                static_cast<size_t>(std::min(remaining, static_cast<uint64_t>(buf.size()))) :
+                buf.size();
+        auto src = sl::io::streambuf_source(stream->rdbuf());
+        size_t len = sl::io::read_all(src, {buf.data(), limit});
+        if (length_known) {
+            remaining -= len;
+            // stream is shorter than 'Content-Length'
+            truncated = len < limit;
+            exhausted = 0 == remaining || truncated;
+        } else {
+            exhausted = len < limit;
+            if (!exhausted) {
+                capacity = std::min(capacity * 2, stream_buffer_max_size);
+            }
         }
+        return len;
     }
 
 };
@@ -41,9 +41,13 @@
 
 #include "wilton/support/exception.hpp"
 
+#include "blocking_io_pool.hpp"
 #include "conf/server_config.hpp"
+#include "handlers/asset_cache.hpp"
 #include "handlers/file_handler.hpp"
+#include "handlers/handlers_common.hpp"
 #include "handlers/loader_handler.hpp"
+#include "handlers/resource_cache.hpp"
 #include "handlers/zip_handler.hpp"
 #include "mustache_cache.hpp"
 #include "request.hpp"
@@ -56,18 +60,10 @@ namespace { // anonymous
 
 using partmap_type = const std::map<std::string, std::string>&;
 
-const std::string mustache_ext = ".mustache";
-
 void handle_not_found_request(sl::pion::http_request_ptr req, sl::pion::response_writer_ptr resp) {
-    auto msg = sl::json::dumps({
-        {"error", {
-            { "code", sl::pion::http_request::RESPONSE_CODE_NOT_FOUND },
-            { "message", sl::pion::http_request::RESPONSE_MESSAGE_NOT_FOUND },
-            { "path", req->get_resource() }}}
-    });
     resp->get_response().set_status_code(404);
     resp->get_response().set_status_message(sl::pion::http_request::RESPONSE_MESSAGE_NOT_FOUND);
-    resp->write(msg);
+    resp->write(handlers::not_found_body().render(req->get_resource()));
     resp->send(std::move(resp));
 }
 
@@ -75,13 +71,21 @@ void handle_not_found_request(sl::pion::http_request_ptr req, sl::pion::response
 
 class sserver::impl : public sl::pimpl::object::impl {
     mustache_cache mustache_templates;
-    std::map<std::string, std::string> mustache_partials;
+    std::shared_ptr<handlers::asset_cache> assets;
+    std::shared_ptr<blocking_io_pool> io_pool;
+    std::shared_ptr<handlers::resource_cache> resources;
     std::unique_ptr<sl::pion::http_server> server_ptr;
 
 public:
     impl(server::conf::server_config conf, std::vector<sl::support::observer_ptr<http_path>> paths) :
-    mustache_templates(),
-    mustache_partials(load_partials(conf.mustache)),
+    mustache_templates(conf.mustache),
+    assets(conf.assetCache.is_enabled() ?
+            std::make_shared<handlers::asset_cache>(conf.assetCache) :
+            std::shared_ptr<handlers::asset_cache>()),
+    io_pool(std::make_shared<blocking_io_pool>(conf.blockingIoThreads)),
+    resources(conf.resourceCacheMaxBytes > 0 ?
+            std::make_shared<handlers::resource_cache>(conf.resourceCacheMaxBytes) :
+            std::shared_ptr<handlers::resource_cache>()),
     server_ptr(std::unique_ptr<sl::pion::http_server>(new sl::pion::http_server(
             conf.numberOfThreads, 
             conf.tcpPort,
@@ -107,12 +111,13 @@ public:
                         [ha, this](sl::pion::http_request_ptr req, sl::pion::response_writer_ptr resp) {
                             request req_wrap{static_cast<void*> (std::addressof(req)),
                                     static_cast<void*> (std::addressof(resp)),
-                                    this->mustache_templates, this->mustache_partials};
+                                    this->mustache_templates, this->io_pool};
                             ha(req_wrap);
                             req_wrap.finish();
                         });
-                server_ptr->add_payload_handler(pa->method, pa->path, [conf_ptr](sl::pion::http_request_ptr& /* request */) {
-                    return request_payload_handler(*conf_ptr);
+                server_ptr->add_payload_handler(pa->method, pa->path, [conf_ptr](sl::pion::http_request_ptr& request) {
+                    return request_payload_handler(conf_ptr, request->get_header("Content-Length"),
+                            request->get_header("Content-Type"));
                 });
             }
         }
@@ -134,12 +139,18 @@ public:
         for (const auto& dr : conf.documentRoots) {
             if (dr.dirPath.length() > 0) {
                 check_dir_path(dr.dirPath);
-                server_ptr->add_handler("GET", dr.resource, handlers::file_handler(dr));
+                auto ha = handlers::file_handler(dr, assets, io_pool);
+                server_ptr->add_handler("GET", dr.resource, ha);
+                server_ptr->add_handler("HEAD", dr.resource, ha);
             } else if (dr.zipPath.length() > 0) {
                 check_zip_path(dr.zipPath);
-                server_ptr->add_handler("GET", dr.resource, handlers::zip_handler(dr));
+                auto ha = handlers::zip_handler(dr, assets, io_pool);
+                server_ptr->add_handler("GET", dr.resource, ha);
+                server_ptr->add_handler("HEAD", dr.resource, ha);
             } else if (dr.useResourceLoader) {
-                server_ptr->add_handler("GET", dr.resource, handlers::loader_handler(dr));
+                auto ha = handlers::loader_handler(dr, resources, assets);
+                server_ptr->add_handler("GET", dr.resource, ha);
+                server_ptr->add_handler("HEAD", dr.resource, ha);
             } else throw support::exception(TRACEMSG(
                     "Invalid 'documentRoot': [" + dr.to_json().dumps() + "]"));
         }
@@ -150,8 +161,15 @@ public:
         server_ptr->start();
     }
 
+    ~impl() STATICLIB_NOEXCEPT {
+        // queued reads post to the IO service owned by the server,
+        // handlers keep the pool alive, so it is stopped explicitly
+        io_pool->stop();
+    }
+
     void stop(sserver&) {
         server_ptr->stop();
+        io_pool->stop();
     }
 
     void broadcast_websocket(sserver&, const std::string& path, sl::io::span<const char> message,
@@ -163,6 +181,37 @@ public:
         return server_ptr->get_tcp_endpoint().port();
     }
 
+    sl::json::value get_asset_cache_stats(sserver&) {
+        if (nullptr == assets.get()) {
+            return {
+                { "hits", 0 },
+                { "misses", 0 },
+                { "evictions", 0 },
+                { "entries", 0 },
+                { "bytes", 0 }
+            };
+        }
+        return assets->stats();
+    }
+
+    sl::json::value get_blocking_io_stats(sserver&) {
+        return io_pool->stats();
+    }
+
+    void invalidate_resource_cache(sserver&, const std::string& prefix) {
+        if (nullptr != resources.get()) {
+            resources->invalidate(prefix);
+        }
+    }
+
+    sl::json::value get_mustache_templates(sserver&) {
+        return mustache_templates.loaded_templates();
+    }
+
+    void reload_mustache(sserver&) {
+        mustache_templates.reload();
+    }
+
 private:
     static std::function<std::string(std::size_t, asio::ssl::context::password_purpose)> create_pwd_cb(const std::string& password) {
         return [password](std::size_t, asio::ssl::context::password_purpose) {
@@ -210,29 +259,6 @@ private:
         };
     }
     
-    static std::map<std::string, std::string> load_partials(const server::conf::mustache_config& cf) {
-        std::map<std::string, std::string> res;
-        for (const std::string& dirpath : cf.partialsDirs) {
-            for (const sl::tinydir::path& tf : sl::tinydir::list_directory(dirpath)) {
-                if (!sl::utils::ends_with(tf.filename(), mustache_ext)) continue;
-                std::string name = std::string(tf.filename().data(), tf.filename().length() - mustache_ext.length());
-                std::string val = read_file(tf);
-                auto pa = res.insert(std::make_pair(std::move(name), std::move(val)));
-                if (!pa.second) throw support::exception(TRACEMSG(
-                        "Invalid duplicate 'mustache.partialsDirs' element," +
-                        " dirpath: [" + dirpath + "], path: [" + tf.filepath() + "]"));
-            }
-        }
-        return res;
-    }
-
-    static std::string read_file(const sl::tinydir::path& tf) {
-        auto fd = tf.open_read();
-        sl::io::string_sink sink{};
-        sl::io::copy_all(fd, sink);
-        return std::move(sink.get_string());
-    }
-
     static void check_dir_path(const std::string& dir) {
         auto path = sl::tinydir::path(dir);
         if (!(path.exists() && path.is_directory())) throw support::exception(TRACEMSG(
@@ -251,6 +277,11 @@ PIMPL_FORWARD_METHOD(sserver, void, stop, (), (), support::exception)
 PIMPL_FORWARD_METHOD(sserver, void, broadcast_websocket, (const std::string&)
         (sl::io::span<const char>)(const std::set<std::string>&), (), support::exception)
 PIMPL_FORWARD_METHOD(sserver, uint16_t, get_tcp_port, (), (), support::exception)
+PIMPL_FORWARD_METHOD(sserver, sl::json::value, get_asset_cache_stats, (), (), support::exception)
+PIMPL_FORWARD_METHOD(sserver, sl::json::value, get_blocking_io_stats, (), (), support::exception)
+PIMPL_FORWARD_METHOD(sserver, void, invalidate_resource_cache, (const std::string&), (), support::exception)
+PIMPL_FORWARD_METHOD(sserver, sl::json::value, get_mustache_templates, (), (), support::exception)
+PIMPL_FORWARD_METHOD(sserver, void, reload_mustache, (), (), support::exception)
 
 } // namespace
 }
@@ -27,6 +27,7 @@
 #include <set>
 #include <vector>
 
+#include "staticlib/json.hpp"
 #include "staticlib/pimpl.hpp"
 
 #include "conf/server_config.hpp"
@@ -58,6 +59,16 @@ public:
             const std::set<std::string>& dest_ids);
 
     uint16_t get_tcp_port();
+
+    sl::json::value get_asset_cache_stats();
+
+    sl::json::value get_blocking_io_stats();
+
+    void invalidate_resource_cache(const std::string& prefix);
+
+    sl::json::value get_mustache_templates();
+
+    void reload_mustache();
 };
 
 } // namespace
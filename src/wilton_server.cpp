@@ -23,6 +23,7 @@
 
 #include "wilton/wilton_server.h"
 
+#include <cstring>
 #include <functional>
 #include <set>
 #include <string>
@@ -36,6 +37,7 @@
 
 #include "wilton/support/alloc.hpp"
 #include "wilton/support/buffer.hpp"
+#include "wilton/support/exception.hpp"
 
 #include "conf/response_metadata.hpp"
 #include "http_path.hpp"
@@ -233,6 +235,79 @@ char* wilton_Server_get_tcp_port(wilton_Server* server, int* port_out) {
     }
 }
 
+char* wilton_Server_get_asset_cache_stats(wilton_Server* server, char** stats_json_out,
+        int* stats_json_len_out) {
+    if (nullptr == server) return wilton::support::alloc_copy(TRACEMSG("Null 'server' parameter specified"));
+    if (nullptr == stats_json_out) return wilton::support::alloc_copy(TRACEMSG("Null 'stats_json_out' parameter specified"));
+    if (nullptr == stats_json_len_out) return wilton::support::alloc_copy(TRACEMSG("Null 'stats_json_len_out' parameter specified"));
+    try {
+        auto json = server->impl().get_asset_cache_stats();
+        std::string res = json.dumps();
+        *stats_json_out = wilton::support::alloc_copy(res);
+        *stats_json_len_out = static_cast<int>(res.length());
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_Server_get_blocking_io_stats(wilton_Server* server, char** stats_json_out,
+        int* stats_json_len_out) {
+    if (nullptr == server) return wilton::support::alloc_copy(TRACEMSG("Null 'server' parameter specified"));
+    if (nullptr == stats_json_out) return wilton::support::alloc_copy(TRACEMSG("Null 'stats_json_out' parameter specified"));
+    if (nullptr == stats_json_len_out) return wilton::support::alloc_copy(TRACEMSG("Null 'stats_json_len_out' parameter specified"));
+    try {
+        auto json = server->impl().get_blocking_io_stats();
+        std::string res = json.dumps();
+        *stats_json_out = wilton::support::alloc_copy(res);
+        *stats_json_len_out = static_cast<int>(res.length());
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_Server_invalidate_resource_cache(wilton_Server* server, const char* prefix,
+        int prefix_len) {
+    if (nullptr == server) return wilton::support::alloc_copy(TRACEMSG("Null 'server' parameter specified"));
+    if (nullptr == prefix) return wilton::support::alloc_copy(TRACEMSG("Null 'prefix' parameter specified"));
+    if (!sl::support::is_uint32(prefix_len)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'prefix_len' parameter specified: [" + sl::support::to_string(prefix_len) + "]"));
+    try {
+        auto prefix_str = std::string(prefix, static_cast<size_t>(prefix_len));
+        server->impl().invalidate_resource_cache(prefix_str);
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_Server_get_mustache_templates(wilton_Server* server, char** templates_json_out,
+        int* templates_json_len_out) {
+    if (nullptr == server) return wilton::support::alloc_copy(TRACEMSG("Null 'server' parameter specified"));
+    if (nullptr == templates_json_out) return wilton::support::alloc_copy(TRACEMSG("Null 'templates_json_out' parameter specified"));
+    if (nullptr == templates_json_len_out) return wilton::support::alloc_copy(TRACEMSG("Null 'templates_json_len_out' parameter specified"));
+    try {
+        auto json = server->impl().get_mustache_templates();
+        std::string res = json.dumps();
+        *templates_json_out = wilton::support::alloc_copy(res);
+        *templates_json_len_out = static_cast<int>(res.length());
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_Server_reload_mustache(wilton_Server* server) {
+    if (nullptr == server) return wilton::support::alloc_copy(TRACEMSG("Null 'server' parameter specified"));
+    try {
+        server->impl().reload_mustache();
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
 char* wilton_Request_get_request_metadata(wilton_Request* request, char** metadata_json_out,
         int* metadata_json_len_out) /* noexcept */ {
     if (nullptr == request) return wilton::support::alloc_copy(TRACEMSG("Null 'server' parameter specified"));
@@ -288,6 +363,52 @@ char* wilton_Request_get_request_data(wilton_Request* request, char** data_out,
     }
 }
 
+char* wilton_Request_get_request_data_span(wilton_Request* request, const char** data_out,
+        long long* data_len_out) /* noexcept */ {
+    if (nullptr == request) return wilton::support::alloc_copy(TRACEMSG("Null 'request' parameter specified"));
+    if (nullptr == data_out) return wilton::support::alloc_copy(TRACEMSG("Null 'data_out' parameter specified"));
+    if (nullptr == data_len_out) return wilton::support::alloc_copy(TRACEMSG("Null 'data_len_out' parameter specified"));
+    try {
+        auto span = request->impl().get_request_data_span();
+        *data_out = span.data();
+        *data_len_out = static_cast<long long>(span.size());
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
+char* wilton_Request_read_request_data(wilton_Request* request, long long offset, int length,
+        char** data_out, int* data_len_out) /* noexcept */ {
+    if (nullptr == request) return wilton::support::alloc_copy(TRACEMSG("Null 'request' parameter specified"));
+    if (offset < 0) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'offset' parameter specified: [" + sl::support::to_string(offset) + "]"));
+    if (!sl::support::is_uint32(length)) return wilton::support::alloc_copy(TRACEMSG(
+            "Invalid 'length' parameter specified: [" + sl::support::to_string(length) + "]"));
+    if (nullptr == data_out) return wilton::support::alloc_copy(TRACEMSG("Null 'data_out' parameter specified"));
+    if (nullptr == data_len_out) return wilton::support::alloc_copy(TRACEMSG("Null 'data_len_out' parameter specified"));
+    try {
+        auto span = request->impl().get_request_data_span();
+        auto off = static_cast<uint64_t>(offset);
+        size_t start = off < span.size() ? static_cast<size_t>(off) : span.size();
+        size_t avail = span.size() - start;
+        size_t len = static_cast<size_t>(length) < avail ? static_cast<size_t>(length) : avail;
+        // copied from the body directly, null-terminated the same way as 'alloc_copy' results
+        char* res = wilton_alloc(static_cast<int>(len + 1));
+        if (nullptr == res) throw wilton::support::exception(TRACEMSG(
+                "Error allocating request data buffer, length: [" + sl::support::to_string(len) + "]"));
+        if (len > 0) {
+            std::memcpy(res, span.data() + start, len);
+        }
+        res[len] = '\0';
+        *data_out = res;
+        *data_len_out = static_cast<int>(len);
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
 char* wilton_Request_get_request_form_data(wilton_Request* request, char** data_out,
         int* data_len_out) /* noexcept */ {
     if (nullptr == request) return wilton::support::alloc_copy(TRACEMSG("Null 'request' parameter specified"));
@@ -304,6 +425,22 @@ char* wilton_Request_get_request_form_data(wilton_Request* request, char** data_
     }
 }
 
+char* wilton_Request_get_request_multipart_data(wilton_Request* request, char** data_out,
+        int* data_len_out) /* noexcept */ {
+    if (nullptr == request) return wilton::support::alloc_copy(TRACEMSG("Null 'request' parameter specified"));
+    if (nullptr == data_out) return wilton::support::alloc_copy(TRACEMSG("Null 'data_out' parameter specified"));
+    if (nullptr == data_len_out) return wilton::support::alloc_copy(TRACEMSG("Null 'data_len_out' parameter specified"));
+    try {
+        sl::json::value json = request->impl().get_request_multipart_data();
+        wilton::support::buffer res = wilton::support::make_json_buffer(json);
+        *data_out = res.data();
+        *data_len_out = res.size_int();
+        return nullptr;
+    } catch (const std::exception& e) {
+        return wilton::support::alloc_copy(TRACEMSG(e.what() + "\nException raised"));
+    }
+}
+
 char* wilton_Request_get_request_data_filename(wilton_Request* request, 
         char** filename_out, int* filename_len_out) /* noexcept */ {
     if (nullptr == request) return wilton::support::alloc_copy(TRACEMSG("Null 'request' parameter specified"));
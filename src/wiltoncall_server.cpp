@@ -22,6 +22,7 @@
  */
 
 #include <cstdio>
+#include <limits>
 #include <list>
 #include <memory>
 #include <string>
@@ -394,6 +395,160 @@ support::buffer get_tcp_port(sl::io::span<const char> data) {
     });
 }
 
+support::buffer get_asset_cache_stats(sl::io::span<const char> data) {
+    // json parse
+    auto json = sl::json::load(data);
+    int64_t handle = -1;
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("serverHandle" == name) {
+            handle = fi.as_int64_or_throw(name);
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (-1 == handle) throw support::exception(TRACEMSG(
+            "Required parameter 'serverHandle' not specified"));
+    // get handle
+    auto sreg = server_registry();
+    auto pa = sreg->remove(handle);
+    if (nullptr == pa->first) throw support::exception(TRACEMSG(
+            "Invalid 'serverHandle' parameter specified"));
+    // call wilton
+    char* out = nullptr;
+    int out_len = 0;
+    char* err = wilton_Server_get_asset_cache_stats(pa->first,
+            std::addressof(out), std::addressof(out_len));
+    sreg->put(pa);
+    if (nullptr != err) {
+        support::throw_wilton_error(err, TRACEMSG(err));
+    }
+    return support::wrap_wilton_buffer(out, out_len);
+}
+
+support::buffer get_blocking_io_stats(sl::io::span<const char> data) {
+    // json parse
+    auto json = sl::json::load(data);
+    int64_t handle = -1;
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("serverHandle" == name) {
+            handle = fi.as_int64_or_throw(name);
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (-1 == handle) throw support::exception(TRACEMSG(
+            "Required parameter 'serverHandle' not specified"));
+    // get handle
+    auto sreg = server_registry();
+    auto pa = sreg->remove(handle);
+    if (nullptr == pa->first) throw support::exception(TRACEMSG(
+            "Invalid 'serverHandle' parameter specified"));
+    // call wilton
+    char* out = nullptr;
+    int out_len = 0;
+    char* err = wilton_Server_get_blocking_io_stats(pa->first,
+            std::addressof(out), std::addressof(out_len));
+    sreg->put(pa);
+    if (nullptr != err) {
+        support::throw_wilton_error(err, TRACEMSG(err));
+    }
+    return support::wrap_wilton_buffer(out, out_len);
+}
+
+support::buffer invalidate_resource_cache(sl::io::span<const char> data) {
+    // json parse
+    auto json = sl::json::load(data);
+    int64_t handle = -1;
+    auto rprefix = std::ref(sl::utils::empty_string());
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("serverHandle" == name) {
+            handle = fi.as_int64_or_throw(name);
+        } else if ("prefix" == name) {
+            rprefix = fi.as_string_or_throw(name);
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (-1 == handle) throw support::exception(TRACEMSG(
+            "Required parameter 'serverHandle' not specified"));
+    const std::string& prefix = rprefix.get();
+    // get handle
+    auto sreg = server_registry();
+    auto pa = sreg->remove(handle);
+    if (nullptr == pa->first) throw support::exception(TRACEMSG(
+            "Invalid 'serverHandle' parameter specified"));
+    // call wilton
+    char* err = wilton_Server_invalidate_resource_cache(pa->first,
+            prefix.c_str(), static_cast<int>(prefix.length()));
+    sreg->put(pa);
+    if (nullptr != err) {
+        support::throw_wilton_error(err, TRACEMSG(err));
+    }
+    return support::make_null_buffer();
+}
+
+support::buffer get_mustache_templates(sl::io::span<const char> data) {
+    // json parse
+    auto json = sl::json::load(data);
+    int64_t handle = -1;
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("serverHandle" == name) {
+            handle = fi.as_int64_or_throw(name);
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (-1 == handle) throw support::exception(TRACEMSG(
+            "Required parameter 'serverHandle' not specified"));
+    // get handle
+    auto sreg = server_registry();
+    auto pa = sreg->remove(handle);
+    if (nullptr == pa->first) throw support::exception(TRACEMSG(
+            "Invalid 'serverHandle' parameter specified"));
+    // call wilton
+    char* out = nullptr;
+    int out_len = 0;
+    char* err = wilton_Server_get_mustache_templates(pa->first,
+            std::addressof(out), std::addressof(out_len));
+    sreg->put(pa);
+    if (nullptr != err) {
+        support::throw_wilton_error(err, TRACEMSG(err));
+    }
+    return support::wrap_wilton_buffer(out, out_len);
+}
+
+support::buffer reload_mustache(sl::io::span<const char> data) {
+    // json parse
+    auto json = sl::json::load(data);
+    int64_t handle = -1;
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("serverHandle" == name) {
+            handle = fi.as_int64_or_throw(name);
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (-1 == handle) throw support::exception(TRACEMSG(
+            "Required parameter 'serverHandle' not specified"));
+    // get handle
+    auto sreg = server_registry();
+    auto pa = sreg->remove(handle);
+    if (nullptr == pa->first) throw support::exception(TRACEMSG(
+            "Invalid 'serverHandle' parameter specified"));
+    // call wilton
+    char* err = wilton_Server_reload_mustache(pa->first);
+    sreg->put(pa);
+    if (nullptr != err) {
+        support::throw_wilton_error(err, TRACEMSG(err));
+    }
+    return support::make_null_buffer();
+}
+
 support::buffer request_get_metadata(sl::io::span<const char> data) {
     // json parse
     auto json = sl::json::load(data);
@@ -454,6 +609,74 @@ support::buffer request_get_data(sl::io::span<const char> data) {
     return support::wrap_wilton_buffer(out, out_len);
 }
 
+support::buffer request_get_data_size(sl::io::span<const char> data) {
+    // json parse
+    auto json = sl::json::load(data);
+    int64_t handle = -1;
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("requestHandle" == name) {
+            handle = fi.as_int64_or_throw(name);
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (-1 == handle) throw support::exception(TRACEMSG(
+            "Required parameter 'requestHandle' not specified"));
+    // get handle
+    auto rreg = request_registry();
+    wilton_Request* request = rreg->remove(handle);
+    if (nullptr == request) throw support::exception(TRACEMSG(
+            "Invalid 'requestHandle' parameter specified"));
+    // call wilton
+    const char* out = nullptr;
+    long long out_len = 0;
+    char* err = wilton_Request_get_request_data_span(request,
+            std::addressof(out), std::addressof(out_len));
+    rreg->put(request);
+    if (nullptr != err) support::throw_wilton_error(err, TRACEMSG(err));
+    return support::make_json_buffer({
+        { "size", static_cast<int64_t>(out_len) }
+    });
+}
+
+support::buffer request_read_data(sl::io::span<const char> data) {
+    // json parse
+    auto json = sl::json::load(data);
+    int64_t handle = -1;
+    int64_t offset = 0;
+    uint32_t length = 0;
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("requestHandle" == name) {
+            handle = fi.as_int64_or_throw(name);
+        } else if ("offset" == name) {
+            offset = fi.as_int64_or_throw(name);
+        } else if ("length" == name) {
+            length = fi.as_uint32_or_throw(name);
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (-1 == handle) throw support::exception(TRACEMSG(
+            "Required parameter 'requestHandle' not specified"));
+    if (length > static_cast<uint32_t>(std::numeric_limits<int>::max())) throw support::exception(TRACEMSG(
+            "Invalid 'length' parameter specified: [" + sl::support::to_string(length) + "]"));
+    // get handle
+    auto rreg = request_registry();
+    wilton_Request* request = rreg->remove(handle);
+    if (nullptr == request) throw support::exception(TRACEMSG(
+            "Invalid 'requestHandle' parameter specified"));
+    // call wilton
+    char* out = nullptr;
+    int out_len = 0;
+    char* err = wilton_Request_read_request_data(request, static_cast<long long>(offset),
+            static_cast<int>(length), std::addressof(out), std::addressof(out_len));
+    rreg->put(request);
+    if (nullptr != err) support::throw_wilton_error(err, TRACEMSG(err));
+    return support::wrap_wilton_buffer(out, out_len);
+}
+
 support::buffer request_get_form_data(sl::io::span<const char> data) {
     // json parse
     auto json = sl::json::load(data);
@@ -483,6 +706,35 @@ support::buffer request_get_form_data(sl::io::span<const char> data) {
     return support::wrap_wilton_buffer(out, out_len);
 }
 
+support::buffer request_get_multipart_data(sl::io::span<const char> data) {
+    // json parse
+    auto json = sl::json::load(data);
+    int64_t handle = -1;
+    for (const sl::json::field& fi : json.as_object()) {
+        auto& name = fi.name();
+        if ("requestHandle" == name) {
+            handle = fi.as_int64_or_throw(name);
+        } else {
+            throw support::exception(TRACEMSG("Unknown data field: [" + name + "]"));
+        }
+    }
+    if (-1 == handle) throw support::exception(TRACEMSG(
+            "Required parameter 'requestHandle' not specified"));
+    // get handle
+    auto rreg = request_registry();
+    wilton_Request* request = rreg->remove(handle);
+    if (nullptr == request) throw support::exception(TRACEMSG(
+            "Invalid 'requestHandle' parameter specified"));
+    // call wilton
+    char* out = nullptr;
+    int out_len = 0;
+    char* err = wilton_Request_get_request_multipart_data(request,
+            std::addressof(out), std::addressof(out_len));
+    rreg->put(request);
+    if (nullptr != err) support::throw_wilton_error(err, TRACEMSG(err));
+    return support::wrap_wilton_buffer(out, out_len);
+}
+
 support::buffer request_get_data_filename(sl::io::span<const char> data) {
     // json parse
     auto json = sl::json::load(data);
@@ -843,9 +1095,17 @@ extern "C" char* wilton_module_init() {
         wilton::support::register_wiltoncall("server_stop", wilton::server::server_stop);
         wilton::support::register_wiltoncall("server_broadcast_websocket", wilton::server::server_broadcast_websocket);
         wilton::support::register_wiltoncall("server_get_tcp_port", wilton::server::get_tcp_port);
+        wilton::support::register_wiltoncall("server_get_asset_cache_stats", wilton::server::get_asset_cache_stats);
+        wilton::support::register_wiltoncall("server_get_blocking_io_stats", wilton::server::get_blocking_io_stats);
+        wilton::support::register_wiltoncall("server_invalidate_resource_cache", wilton::server::invalidate_resource_cache);
+        wilton::support::register_wiltoncall("server_get_mustache_templates", wilton::server::get_mustache_templates);
+        wilton::support::register_wiltoncall("server_reload_mustache", wilton::server::reload_mustache);
         wilton::support::register_wiltoncall("request_get_metadata", wilton::server::request_get_metadata);
         wilton::support::register_wiltoncall("request_get_data", wilton::server::request_get_data);
+        wilton::support::register_wiltoncall("request_get_data_size", wilton::server::request_get_data_size);
+        wilton::support::register_wiltoncall("request_read_data", wilton::server::request_read_data);
         wilton::support::register_wiltoncall("request_get_form_data", wilton::server::request_get_form_data);
+        wilton::support::register_wiltoncall("request_get_multipart_data", wilton::server::request_get_multipart_data);
         wilton::support::register_wiltoncall("request_get_data_filename", wilton::server::request_get_data_filename);
         wilton::support::register_wiltoncall("request_set_response_metadata", wilton::server::request_set_response_metadata);
         wilton::support::register_wiltoncall("request_send_response", wilton::server::request_send_response);